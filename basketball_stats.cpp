@@ -1,592 +1,7188 @@
 #include <iostream>
 #include <fstream>
 #include <vector>
+#include <list>
+#include <unordered_map>
 #include <string>
 #include <algorithm>
 #include <iomanip>
 #include <sstream>
 #include <cmath>
+#include <cctype>
+#include <cstdio>
+#include <cstdint>
+#include <cstring>
+#include <cstdlib>
+#include <new>
+#include <string_view>
+#include <charconv>
+#include <system_error>
+#include <filesystem>
+#include <thread>
+#include <atomic>
+#include <memory>
+#include <chrono>
+#include <random>
+#include <mutex>
+#include <condition_variable>
+#include <cerrno>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define BSTATS_HAVE_AVX2 1
+#include <immintrin.h>
+#endif
+#if defined(__ARM_NEON) && defined(__aarch64__)
+#define BSTATS_HAVE_NEON 1
+#include <arm_neon.h>
+#endif
+
+// Fully unroll the next loop; used where a loop walks the constexpr stat
+// schema tables so their entries fold into constants
+#if defined(__GNUC__)
+#define BSTATS_UNROLL _Pragma("GCC unroll 16")
+#else
+#define BSTATS_UNROLL
+#endif
+
+#ifdef _WIN32
+#include <io.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/ioctl.h>
+#include <unistd.h>
+#include <csignal>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/socket.h>
+#endif
+#ifdef __linux__
+#include <sys/epoll.h>
+#endif
 
 using namespace std;
 
 // ======================================================
-// STRUCTS
+// INSTRUMENTATION: scoped timers and counters on the hot paths
+// ======================================================
+
+// Build with -DBSTATS_INSTRUMENT=0 to compile every probe out
+#ifndef BSTATS_INSTRUMENT
+#define BSTATS_INSTRUMENT 1
+#endif
+
+enum ProbeId {
+    PROBE_LOAD_TEXT, PROBE_LOAD_SNAPSHOT, PROBE_LOAD_ARCHIVE, PROBE_SAVE_TEXT, PROBE_SAVE_SNAPSHOT, PROBE_SAVE_ARCHIVE,
+    PROBE_PAGE_IN, PROBE_COMPACT, PROBE_JOURNAL_REPLAY, PROBE_JOURNAL_COMMIT, PROBE_IMPORT_CSV, PROBE_INGEST_BATCH,
+    PROBE_EXPORT_CSV, PROBE_EXPORT_LEAGUE_CSV,
+    PROBE_SORT, PROBE_VIEW_BUILD,
+    PROBE_SHOW_TOTALS, PROBE_SHOW_AVERAGES, PROBE_SHOW_ADVANCED, PROBE_SHOW_BEST, PROBE_SHOW_CHART, PROBE_SHOW_QUERY,
+    PROBE_QUICK_REPORT, PROBE_LEADERBOARD, PROBE_GROUP_BY, PROBE_SERVE_REQUEST, PROBE_OUTPUT,
+    NUM_PROBES
+};
+
+const char* const PROBE_NAMES[NUM_PROBES] = {
+    "load_text", "load_snapshot", "load_archive", "save_text", "save_snapshot", "save_archive",
+    "page_in", "compact", "journal_replay", "journal_commit", "import_csv", "ingest_batch",
+    "export_csv", "export_league_csv",
+    "sort", "view_build",
+    "show_totals", "show_averages", "show_advanced", "show_best", "show_chart", "show_query",
+    "quick_report", "leaderboard", "group_by", "serve_request", "console_output"
+};
+
+#if BSTATS_INSTRUMENT
+// Counters are relaxed atomics: probes fire from the parallel report workers
+struct ProbeStats {
+    atomic<uint64_t> calls{ 0 }, totalNs{ 0 }, maxNs{ 0 };
+    atomic<uint64_t> bytesRead{ 0 }, bytesWritten{ 0 }, allocs{ 0 };
+};
+
+ProbeStats probes[NUM_PROBES];
+thread_local uint64_t threadAllocs = 0;
+
+// Program-wide allocation count, kept in one cache line per thread so that
+// counting never contends. A thread claims a free slot on its first
+// allocation and frees it on exit; the count stays in the slot for the next
+// owner. Threads beyond the last private slot share the final one.
+struct alignas(64) AllocSlot {
+    atomic<uint64_t> count{ 0 };
+    atomic<bool> used{ false };
+};
+
+const int ALLOC_SLOTS = 256;
+AllocSlot allocSlots[ALLOC_SLOTS];
+AllocSlot& sharedAllocSlot = allocSlots[ALLOC_SLOTS - 1];
+
+struct AllocLease {
+    AllocSlot* slot = nullptr;
+
+    void count() {
+        if (!slot) {
+            slot = &sharedAllocSlot;
+            for (int i = 0; i < ALLOC_SLOTS - 1; ++i) {
+                bool idle = false;
+                if (allocSlots[i].used.compare_exchange_strong(idle, true, memory_order_acquire)) { slot = &allocSlots[i]; break; }
+            }
+        }
+        if (slot == &sharedAllocSlot) slot->count.fetch_add(1, memory_order_relaxed);
+        else slot->count.store(slot->count.load(memory_order_relaxed) + 1, memory_order_relaxed);
+    }
+
+    ~AllocLease() {
+        if (slot && slot != &sharedAllocSlot) slot->used.store(false, memory_order_release);
+    }
+};
+
+thread_local AllocLease allocLease;
+
+uint64_t allocationCount() {
+    uint64_t n = 0;
+    for (const AllocSlot& s : allocSlots) n += s.count.load(memory_order_relaxed);
+    return n;
+}
+
+uint64_t nowNs() {
+    return (uint64_t)chrono::duration_cast<chrono::nanoseconds>(chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+const uint64_t PROGRAM_START_NS = nowNs();
+
+// Chrome trace events, recorded only while tracing (--trace)
+struct TraceEvent {
+    ProbeId id;
+    uint32_t thread;
+    uint64_t startNs, durationNs;
+};
+atomic<bool> tracing{ false };
+mutex traceLock;
+vector<TraceEvent> traceEvents;
+
+uint32_t threadNumber() {
+    static atomic<uint32_t> next{ 0 };
+    thread_local uint32_t id = next++;
+    return id;
+}
+
+// Times its scope and charges the calls, time and allocations made in it
+// to one probe. Nested probes are inclusive.
+class ScopedProbe {
+public:
+    explicit ScopedProbe(ProbeId id) : id(id), allocsAtStart(threadAllocs), start(nowNs()) {}
+    ScopedProbe(const ScopedProbe&) = delete;
+    ScopedProbe& operator=(const ScopedProbe&) = delete;
+
+    ~ScopedProbe() {
+        uint64_t ns = nowNs() - start;
+        ProbeStats& p = probes[id];
+        p.calls.fetch_add(1, memory_order_relaxed);
+        p.totalNs.fetch_add(ns, memory_order_relaxed);
+        p.allocs.fetch_add(threadAllocs - allocsAtStart, memory_order_relaxed);
+        uint64_t seen = p.maxNs.load(memory_order_relaxed);
+        while (ns > seen && !p.maxNs.compare_exchange_weak(seen, ns, memory_order_relaxed)) {}
+        if (tracing.load(memory_order_relaxed)) {
+            lock_guard<mutex> g(traceLock);
+            traceEvents.push_back({ id, threadNumber(), start, ns });
+        }
+    }
+
+private:
+    ProbeId id;
+    uint64_t allocsAtStart;
+    uint64_t start;
+};
+
+void probeBytes(ProbeId id, uint64_t read, uint64_t written) {
+    probes[id].bytesRead.fetch_add(read, memory_order_relaxed);
+    probes[id].bytesWritten.fetch_add(written, memory_order_relaxed);
+}
+
+#define BSTATS_CONCAT2(a, b) a##b
+#define BSTATS_CONCAT(a, b) BSTATS_CONCAT2(a, b)
+#define BSTATS_PROBE(id) ScopedProbe BSTATS_CONCAT(probe_, __LINE__)(id)
+#define BSTATS_BYTES(id, read, written) probeBytes(id, read, written)
+#else
+#define BSTATS_PROBE(id) ((void)0)
+#define BSTATS_BYTES(id, read, written) ((void)0)
+#endif
+
+#if BSTATS_INSTRUMENT
+// Every allocation in the program is counted, per thread and in total
+void* operator new(size_t n) {
+    ++threadAllocs;
+    allocLease.count();
+    if (void* p = malloc(n ? n : 1)) return p;
+    throw bad_alloc();
+}
+
+// Kept out of line so GCC does not pair the inlined free with new[] callers
+#ifdef __GNUC__
+__attribute__((noinline))
+#endif
+void operator delete(void* p) noexcept { free(p); }
+void operator delete(void* p, size_t) noexcept { ::operator delete(p); }
+#endif
+
+// Probe table for the stats command: only probes that fired are listed
+void showInstrumentation(ostream& out) {
+#if BSTATS_INSTRUMENT
+    out << "\n=== Instrumentation ===\n\n";
+    out << left << setw(18) << "probe" << right << setw(10) << "calls" << setw(12) << "total ms"
+        << setw(11) << "max ms" << setw(14) << "bytes read" << setw(14) << "bytes written" << setw(11) << "allocs" << '\n';
+    for (int i = 0; i < NUM_PROBES; ++i) {
+        const ProbeStats& p = probes[i];
+        uint64_t calls = p.calls.load(memory_order_relaxed);
+        if (calls == 0) continue;
+        out << left << setw(18) << PROBE_NAMES[i] << right << setw(10) << calls << fixed << setprecision(3)
+            << setw(12) << p.totalNs.load(memory_order_relaxed) / 1e6 << setw(11) << p.maxNs.load(memory_order_relaxed) / 1e6
+            << setw(14) << p.bytesRead.load(memory_order_relaxed) << setw(14) << p.bytesWritten.load(memory_order_relaxed)
+            << setw(11) << p.allocs.load(memory_order_relaxed) << '\n';
+    }
+    out << "\nAllocations since start: " << allocationCount() << '\n';
+#else
+    out << "Instrumentation is compiled out (built with BSTATS_INSTRUMENT=0).\n";
+#endif
+}
+
+// Write the recorded events as Chrome trace-event JSON (chrome://tracing, Perfetto)
+bool writeTrace(const string& filename) {
+#if BSTATS_INSTRUMENT
+    ofstream out(filename);
+    lock_guard<mutex> g(traceLock);
+    out << "{\"traceEvents\": [";
+    for (size_t i = 0; i < traceEvents.size(); ++i) {
+        const TraceEvent& e = traceEvents[i];
+        out << (i ? ",\n" : "\n") << "{\"name\": \"" << PROBE_NAMES[e.id] << "\", \"ph\": \"X\", \"pid\": 1, \"tid\": "
+            << e.thread << fixed << setprecision(3) << ", \"ts\": " << (e.startNs - PROGRAM_START_NS) / 1e3
+            << ", \"dur\": " << e.durationNs / 1e3 << "}";
+    }
+    out << "\n]}\n";
+    out.close();
+    return (bool)out;
+#else
+    (void)filename;
+    return false;
+#endif
+}
+
+// ======================================================
+// DATES: games store dates as packed 32-bit day numbers
+// ======================================================
+
+// Days since 1970-01-01 for a proleptic Gregorian date (H. Hinnant's
+// days_from_civil). Day numbers sort and subtract like the dates they encode.
+int32_t daysFromCivil(int y, unsigned m, unsigned d) {
+    y -= m <= 2;
+    const int era = (y >= 0 ? y : y - 399) / 400;
+    const unsigned yoe = (unsigned)(y - era * 400);
+    const unsigned doy = (153 * (m > 2 ? m - 3 : m + 9) + 2) / 5 + d - 1;
+    const unsigned doe = yoe * 365 + yoe / 4 - yoe / 100 + doy;
+    return era * 146097 + (int)doe - 719468;
+}
+
+// Inverse of daysFromCivil
+void civilFromDays(int32_t z, int& y, unsigned& m, unsigned& d) {
+    z += 719468;
+    const int era = (z >= 0 ? z : z - 146096) / 146097;
+    const unsigned doe = (unsigned)(z - era * 146097);
+    const unsigned yoe = (doe - doe / 1460 + doe / 36524 - doe / 146096) / 365;
+    const unsigned doy = doe - (365 * yoe + yoe / 4 - yoe / 100);
+    const unsigned mp = (5 * doy + 2) / 153;
+    d = doy - (153 * mp + 2) / 5 + 1;
+    m = mp < 10 ? mp + 3 : mp - 9;
+    y = (int)yoe + era * 400 + (m <= 2);
+}
+
+// Parse and validate a YYYY-MM-DD calendar date into a day number
+bool parseDate(string_view text, int32_t& day) {
+    if (text.size() != 10 || text[4] != '-' || text[7] != '-') return false;
+    int v[3] = {};
+    const size_t start[3] = { 0, 5, 8 }, len[3] = { 4, 2, 2 };
+    for (int f = 0; f < 3; ++f) {
+        for (size_t k = start[f]; k < start[f] + len[f]; ++k) {
+            if (text[k] < '0' || text[k] > '9') return false;
+            v[f] = v[f] * 10 + (text[k] - '0');
+        }
+    }
+    static const int MONTH_DAYS[12] = { 31, 29, 31, 30, 31, 30, 31, 31, 30, 31, 30, 31 };
+    if (v[0] < 1 || v[1] < 1 || v[1] > 12 || v[2] < 1 || v[2] > MONTH_DAYS[v[1] - 1]) return false;
+    bool leap = (v[0] % 4 == 0 && v[0] % 100 != 0) || v[0] % 400 == 0;
+    if (v[1] == 2 && v[2] == 29 && !leap) return false;
+    day = daysFromCivil(v[0], (unsigned)v[1], (unsigned)v[2]);
+    return true;
+}
+
+// Write a day number as YYYY-MM-DD (exactly DATE_CHARS characters, no terminator)
+const size_t DATE_CHARS = 10;
+char* formatDateTo(char* out, int32_t day) {
+    int y; unsigned m, d;
+    civilFromDays(day, y, m, d);
+    int digits[8] = { y / 1000 % 10, y / 100 % 10, y / 10 % 10, y % 10, (int)m / 10, (int)m % 10, (int)d / 10, (int)d % 10 };
+    const int* p = digits;
+    for (size_t k = 0; k < DATE_CHARS; ++k) out[k] = (k == 4 || k == 7) ? '-' : (char)('0' + *p++);
+    return out + DATE_CHARS;
+}
+
+string formatDate(int32_t day) {
+    char buf[DATE_CHARS];
+    formatDateTo(buf, day);
+    return string(buf, DATE_CHARS);
+}
+
+// The season a game belongs to, named by the year it starts in: seasons
+// run from August 1 to July 31, so 2024 is the 2024-25 season
+int32_t seasonOf(int32_t day) {
+    int y; unsigned m, d;
+    civilFromDays(day, y, m, d);
+    return m >= 8 ? y : y - 1;
+}
+
+// A season as shown in reports: "2024-25"
+string formatSeason(int32_t season) {
+    char buf[16];
+    snprintf(buf, sizeof(buf), "%d-%02d", (int)season, (int)((season + 1) % 100 + 100) % 100);
+    return buf;
+}
+
+// ======================================================
+// STAT SCHEMA: the one list of counting stats
+// ======================================================
+
+// Every counting stat, in column order. The StatId enum, the GameStats
+// fields and the STAT_DEFS descriptor table are generated from this list,
+// and storage, the file formats, game entry, validation and the reports all
+// loop over STAT_DEFS, so a new stat (turnovers, fouls, minutes) is one line
+// here. The binary formats store NUM_STATS columns, so adding one also
+// needs a SNAPSHOT_VERSION, ARCHIVE_VERSION and JOURNAL_VERSION bump.
+//   X(id, GameStats field, display name, entry prompt, per-game label, points per unit)
+// The per-game label ("PPG") is empty for the shooting counts, which are
+// reported through SHOT_DEFS instead.
+#define BSTATS_STATS(X) \
+    X(POINTS,   points,   "Points",   "Points",                       "PPG", 0) \
+    X(REBOUNDS, rebounds, "Rebounds", "Rebounds",                     "RPG", 0) \
+    X(ASSISTS,  assists,  "Assists",  "Assists",                      "APG", 0) \
+    X(STEALS,   steals,   "Steals",   "Steals",                       "SPG", 0) \
+    X(BLOCKS,   blocks,   "Blocks",   "Blocks",                       "BPG", 0) \
+    X(FGM,      fgm,      "FGM",      "Field goals made (FGM)",       "",    2) \
+    X(FGA,      fga,      "FGA",      "Field goals attempted (FGA)",  "",    0) \
+    X(3PM,      threem,   "3PM",      "3-pointers made (3PM)",        "",    1) \
+    X(3PA,      threea,   "3PA",      "3-pointers attempted (3PA)",   "",    0) \
+    X(FTM,      ftm,      "FTM",      "Free throws made (FTM)",       "",    1) \
+    X(FTA,      fta,      "FTA",      "Free throws attempted (FTA)",  "",    0)
+
+// Made/attempted pairs, each reported as a percentage
+//   Y(display name, JSON key, made, attempted)
+#define BSTATS_SHOTS(Y) \
+    Y("FG%", "fg_pct", FGM, FGA) \
+    Y("3P%", "3p_pct", 3PM, 3PA) \
+    Y("FT%", "ft_pct", FTM, FTA)
+
+// Column ids for the counting stats; one column per stat in GameStore
+enum StatId {
+#define BSTATS_STAT_ID(id, field, name, prompt, perGame, pointValue) STAT_##id,
+    BSTATS_STATS(BSTATS_STAT_ID)
+#undef BSTATS_STAT_ID
+    NUM_STATS
+};
+
+// ======================================================
+// STRUCTS
+// ======================================================
+
+// Holds stats for a single game
+struct GameStats {
+    int32_t date = 0;   // day number (see parseDate/formatDate); shown as YYYY-MM-DD
+#define BSTATS_STAT_FIELD(id, field, name, prompt, perGame, pointValue) int field = 0;
+    BSTATS_STATS(BSTATS_STAT_FIELD)
+#undef BSTATS_STAT_FIELD
+
+    int team = 0, opponent = 0; // ids in teamDict; 0 = not recorded
+    int venue = 0;              // Venue
+};
+
+// Where a game was played; VENUE_NONE = not recorded
+enum Venue { VENUE_NONE, VENUE_HOME, VENUE_AWAY };
+
+// Column ids for the per-game dimensions: small dictionary-encoded ids
+// stored next to the stats in GameStore, 0 = not recorded. The season a
+// game belongs to is derived from its date (seasonOf) rather than stored.
+enum DimId { DIM_TEAM, DIM_OPPONENT, DIM_VENUE, NUM_DIMS };
+
+const char* const DIM_NAMES[NUM_DIMS] = { "Team", "Opponent", "Venue" };
+
+int GameStats::* const DIM_FIELDS[NUM_DIMS] = { &GameStats::team, &GameStats::opponent, &GameStats::venue };
+
+// Descriptor of one counting stat, generated from BSTATS_STATS
+struct StatDef {
+    const char* name;       // display name and CSV header ("Points", "3PM")
+    const char* field;      // GameStats field, as named in text file errors
+    const char* prompt;     // game entry prompt
+    const char* perGame;    // per-game average label ("PPG"); "" = not averaged
+    int pointValue;         // points scored per unit of the stat
+    int GameStats::* member;
+};
+
+constexpr StatDef STAT_DEFS[NUM_STATS] = {
+#define BSTATS_STAT_DEF(id, field, name, prompt, perGame, pointValue) \
+    { name, #field, prompt, perGame, pointValue, &GameStats::field },
+    BSTATS_STATS(BSTATS_STAT_DEF)
+#undef BSTATS_STAT_DEF
+};
+
+// Display names and GameStats fields, in StatId order
+const char* const STAT_NAMES[NUM_STATS] = {
+#define BSTATS_STAT_NAME(id, field, name, prompt, perGame, pointValue) name,
+    BSTATS_STATS(BSTATS_STAT_NAME)
+#undef BSTATS_STAT_NAME
+};
+
+int GameStats::* const STAT_FIELDS[NUM_STATS] = {
+#define BSTATS_STAT_MEMBER(id, field, name, prompt, perGame, pointValue) &GameStats::field,
+    BSTATS_STATS(BSTATS_STAT_MEMBER)
+#undef BSTATS_STAT_MEMBER
+};
+
+// Lower-case key for a stat ("points", "3pm", ...)
+string statKey(StatId s) {
+    string key = STAT_NAMES[s];
+    for (char& c : key) c = (char)tolower((unsigned char)c);
+    return key;
+}
+
+// A made/attempted pair reported as a percentage, generated from BSTATS_SHOTS
+struct ShotDef {
+    const char* name;       // "FG%"
+    const char* key;        // JSON key
+    StatId made, attempted;
+};
+
+constexpr ShotDef SHOT_DEFS[] = {
+#define BSTATS_SHOT_DEF(name, key, made, attempted) { name, key, STAT_##made, STAT_##attempted },
+    BSTATS_SHOTS(BSTATS_SHOT_DEF)
+#undef BSTATS_SHOT_DEF
+};
+
+const int NUM_SHOTS = (int)(sizeof(SHOT_DEFS) / sizeof(SHOT_DEFS[0]));
+
+// Box-score rules a game must satisfy besides points = the sum of every
+// stat times its pointValue: each pair reads "first <= second". They are
+// the made <= attempted pairs plus 3PM <= FGM (every 3-pointer is also a
+// field goal; game entry raises FGM to match, see STAT_PARTS).
+struct StatRule {
+    StatId first, second;
+};
+
+constexpr StatRule STAT_PARTS[] = { { STAT_3PM, STAT_FGM } };
+
+constexpr StatRule STAT_RULES[] = {
+#define BSTATS_SHOT_RULE(name, key, made, attempted) { STAT_##made, STAT_##attempted },
+    BSTATS_SHOTS(BSTATS_SHOT_RULE)
+#undef BSTATS_SHOT_RULE
+    STAT_PARTS[0]
+};
+
+
+// simplePER's per-game raw value from NUM_STATS values in StatId order
+long long perRawOf(const int32_t* v) {
+    return (long long)v[STAT_POINTS] + v[STAT_REBOUNDS] + v[STAT_ASSISTS] + v[STAT_STEALS] + v[STAT_BLOCKS]
+        - (((long long)v[STAT_FGA] - v[STAT_FGM]) + ((long long)v[STAT_FTA] - v[STAT_FTM]));
+}
+
+// Running aggregate block: the sum of every counting stat plus the simplePER
+// raw total over a set of games. 64-bit so career totals cannot overflow.
+struct StatTotals {
+    long long sum[NUM_STATS] = {};
+    long long perRaw = 0;
+
+    // Add (sign = 1) or remove (sign = -1) one game
+    void apply(const int32_t* v, int sign) {
+        for (int s = 0; s < NUM_STATS; ++s) sum[s] += sign * (long long)v[s];
+        perRaw += sign * perRawOf(v);
+    }
+
+    // Set perRaw from the sums; the PER formula is linear, so this equals
+    // the per-game raw values added up
+    void derivePerRaw() {
+        perRaw = sum[STAT_POINTS] + sum[STAT_REBOUNDS] + sum[STAT_ASSISTS] + sum[STAT_STEALS] + sum[STAT_BLOCKS]
+            - ((sum[STAT_FGA] - sum[STAT_FGM]) + (sum[STAT_FTA] - sum[STAT_FTM]));
+    }
+};
+
+// ======================================================
+// AGGREGATION KERNELS: one-pass column totals (scalar / AVX2 / NEON)
+// ======================================================
+
+// Every kernel sums rows [0, n) of all NUM_STATS columns in a single pass
+// into 64-bit accumulators. The simplePER raw total is linear in the stats,
+// so it is derived from the sums rather than accumulated separately.
+typedef void (*TotalsKernel)(const int32_t* const* cols, size_t n, long long* sums);
+
+void totalsKernelScalar(const int32_t* const* cols, size_t n, long long* sums) {
+    long long acc[NUM_STATS] = {};
+    for (size_t i = 0; i < n; ++i) {
+        for (int s = 0; s < NUM_STATS; ++s) acc[s] += cols[s][i];
+    }
+    for (int s = 0; s < NUM_STATS; ++s) sums[s] = acc[s];
+}
+
+#ifdef BSTATS_HAVE_AVX2
+// 8 games per step: each column's int32 lanes are widened to two 4 x int64
+// halves and added into one accumulator register per stat.
+__attribute__((target("avx2")))
+void totalsKernelAVX2(const int32_t* const* cols, size_t n, long long* sums) {
+    __m256i acc[NUM_STATS];
+    for (int s = 0; s < NUM_STATS; ++s) acc[s] = _mm256_setzero_si256();
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        for (int s = 0; s < NUM_STATS; ++s) {
+            __m256i v = _mm256_loadu_si256((const __m256i*)(cols[s] + i));
+            __m256i lo = _mm256_cvtepi32_epi64(_mm256_castsi256_si128(v));
+            __m256i hi = _mm256_cvtepi32_epi64(_mm256_extracti128_si256(v, 1));
+            acc[s] = _mm256_add_epi64(acc[s], _mm256_add_epi64(lo, hi));
+        }
+    }
+    for (int s = 0; s < NUM_STATS; ++s) {
+        alignas(32) long long lanes[4];
+        _mm256_store_si256((__m256i*)lanes, acc[s]);
+        long long total = lanes[0] + lanes[1] + lanes[2] + lanes[3];
+        for (size_t j = i; j < n; ++j) total += cols[s][j];
+        sums[s] = total;
+    }
+}
+#endif
+
+#ifdef BSTATS_HAVE_NEON
+// 4 games per step with pairwise widening add-accumulate into 2 x int64
+void totalsKernelNEON(const int32_t* const* cols, size_t n, long long* sums) {
+    int64x2_t acc[NUM_STATS];
+    for (int s = 0; s < NUM_STATS; ++s) acc[s] = vdupq_n_s64(0);
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        for (int s = 0; s < NUM_STATS; ++s) acc[s] = vpadalq_s32(acc[s], vld1q_s32(cols[s] + i));
+    }
+    for (int s = 0; s < NUM_STATS; ++s) {
+        long long total = vaddvq_s64(acc[s]);
+        for (size_t j = i; j < n; ++j) total += cols[s][j];
+        sums[s] = total;
+    }
+}
+#endif
+
+struct KernelChoice {
+    TotalsKernel fn;
+    const char* name;
+};
+
+// Pick the widest kernel the running CPU supports
+KernelChoice selectTotalsKernel() {
+#ifdef BSTATS_HAVE_AVX2
+    if (__builtin_cpu_supports("avx2")) return { totalsKernelAVX2, "avx2" };
+#endif
+#ifdef BSTATS_HAVE_NEON
+    return { totalsKernelNEON, "neon" };
+#endif
+    return { totalsKernelScalar, "scalar" };
+}
+
+const KernelChoice TOTALS_KERNEL = selectTotalsKernel();
+
+// Totals over rows [0, n) of the given columns using the selected kernel
+StatTotals computeTotals(const int32_t* const* cols, size_t n) {
+    StatTotals t;
+    TOTALS_KERNEL.fn(cols, n, t.sum);
+    t.derivePerRaw();
+    return t;
+}
+
+// Columnar (struct-of-arrays) storage for a player's games.
+// Every stat lives in its own contiguous int32 column and the dates are a
+// parallel column of day numbers, so scanning one stat only touches that
+// stat's memory. operator[] and iteration hand out GameStats copies so
+// menu code can keep working with whole games. Every mutation keeps the
+// running totals() current, so reports never have to rescan the columns.
+//
+// Games are never reordered in storage. sortedBy() hands out cached
+// permutations (storage indices in sorted order) that are built on first
+// use, patched in place when a game is appended or erased, and rebuilt
+// lazily after an edit.
+class GameStore {
+public:
+    // View keys: a StatId (highest value first) or VIEW_BY_DATE (oldest first).
+    // Ties keep storage order.
+    static const int VIEW_BY_DATE = NUM_STATS;
+    static const int NUM_VIEWS = NUM_STATS + 1;
+
+    class const_iterator {
+    public:
+        const_iterator(const GameStore* s, size_t i) : store(s), idx(i) {}
+        GameStats operator*() const { return (*store)[idx]; }
+        const_iterator& operator++() { ++idx; return *this; }
+        bool operator!=(const const_iterator& o) const { return idx != o.idx; }
+    private:
+        const GameStore* store;
+        size_t idx;
+    };
+
+    size_t size() const { return dates.size(); }
+    bool empty() const { return dates.empty(); }
+
+    void reserve(size_t n) {
+        for (auto& c : cols) c.reserve(n);
+        for (auto& c : dimCols) c.reserve(n);
+        dates.reserve(n);
+    }
+
+    void clear() {
+        for (auto& c : cols) c.clear();
+        for (auto& c : dimCols) c.clear();
+        dates.clear();
+        running = StatTotals();
+        viewsDirty();
+        ++gen;
+    }
+
+    void push_back(const GameStats& g) {
+        int32_t v[NUM_STATS];
+        uint16_t d[NUM_DIMS];
+        for (int s = 0; s < NUM_STATS; ++s) v[s] = g.*STAT_FIELDS[s];
+        for (int k = 0; k < NUM_DIMS; ++k) d[k] = (uint16_t)(g.*DIM_FIELDS[k]);
+        append(g.date, v, d);
+    }
+
+    // Append a game from its day number, NUM_STATS values (StatId order) and
+    // NUM_DIMS dimension ids (DimId order; nullptr = none recorded)
+    void append(int32_t date, const int32_t* stats, const uint16_t* dims = nullptr) {
+        pushColumns(date, stats, dims);
+        running.apply(stats, 1);
+        viewsInsert((uint32_t)size() - 1);
+    }
+
+    // Bulk loading: append without updating the running totals, then call
+    // retotal() once at the end so they are rebuilt with one kernel pass.
+    // Sorted views are rebuilt on next use instead of patched per game.
+    void appendUntracked(int32_t date, const int32_t* stats, const uint16_t* dims = nullptr) {
+        pushColumns(date, stats, dims);
+        viewsDirty();
+    }
+
+    void retotal() { running = rangeTotals(0, size()); }
+
+    // Append every game of another store
+    void appendAll(const GameStore& other) {
+        reserve(size() + other.size());
+        for (int s = 0; s < NUM_STATS; ++s) cols[s].insert(cols[s].end(), other.cols[s].begin(), other.cols[s].end());
+        for (int k = 0; k < NUM_DIMS; ++k) dimCols[k].insert(dimCols[k].end(), other.dimCols[k].begin(), other.dimCols[k].end());
+        dates.insert(dates.end(), other.dates.begin(), other.dates.end());
+        retotal();
+        viewsDirty();
+        ++gen;
+    }
+
+    // Overwrite game i with g
+    void set(size_t i, const GameStats& g) {
+        int32_t v[NUM_STATS];
+        values(i, v);
+        running.apply(v, -1);
+        for (int s = 0; s < NUM_STATS; ++s) cols[s][i] = v[s] = g.*STAT_FIELDS[s];
+        for (int k = 0; k < NUM_DIMS; ++k) dimCols[k][i] = (uint16_t)(g.*DIM_FIELDS[k]);
+        dates[i] = g.date;
+        running.apply(v, 1);
+        viewsDirty();
+        ++gen;
+    }
+
+    void erase(size_t i) {
+        int32_t v[NUM_STATS];
+        values(i, v);
+        running.apply(v, -1);
+        viewsErase((uint32_t)i); // needs the values still in place
+        for (auto& c : cols) c.erase(c.begin() + i);
+        for (auto& c : dimCols) c.erase(c.begin() + i);
+        dates.erase(dates.begin() + i);
+        ++gen;
+    }
+
+    // Storage indices of all games ordered by the given view key
+    const vector<uint32_t>& sortedBy(int key) const {
+        vector<uint32_t>& v = views[key];
+        if (!viewBuilt[key]) {
+            BSTATS_PROBE(PROBE_VIEW_BUILD);
+            v.resize(size());
+            for (uint32_t i = 0; i < v.size(); ++i) v[i] = i;
+            sort(v.begin(), v.end(), [&](uint32_t a, uint32_t b) { return viewLess(key, a, b); });
+            viewBuilt[key] = true;
+        }
+        return v;
+    }
+
+    GameStats operator[](size_t i) const {
+        GameStats g;
+        g.date = dates[i];
+        for (int s = 0; s < NUM_STATS; ++s) g.*STAT_FIELDS[s] = cols[s][i];
+        for (int k = 0; k < NUM_DIMS; ++k) g.*DIM_FIELDS[k] = dimCols[k][i];
+        return g;
+    }
+
+    const_iterator begin() const { return const_iterator(this, 0); }
+    const_iterator end() const { return const_iterator(this, size()); }
+
+    // Raw column access for aggregation loops
+    const int32_t* column(StatId s) const { return cols[s].data(); }
+    int32_t stat(size_t i, StatId s) const { return cols[s][i]; }
+
+    // All NUM_STATS values of game i, in StatId order
+    void values(size_t i, int32_t* v) const {
+        for (int s = 0; s < NUM_STATS; ++s) v[s] = cols[s][i];
+    }
+
+    // Dimension ids of game i: one, all NUM_DIMS in DimId order, a whole column
+    uint16_t dim(size_t i, DimId k) const { return dimCols[k][i]; }
+    void dims(size_t i, uint16_t* d) const {
+        for (int k = 0; k < NUM_DIMS; ++k) d[k] = dimCols[k][i];
+    }
+    const uint16_t* dimColumn(DimId k) const { return dimCols[k].data(); }
+
+    // True if game i has any dimension recorded
+    bool hasDims(size_t i) const {
+        for (const auto& c : dimCols) if (c[i]) return true;
+        return false;
+    }
+
+    // Running sums over every game in the store
+    const StatTotals& totals() const { return running; }
+
+    // Sums over games [begin, end), computed by the aggregation kernel
+    StatTotals rangeTotals(size_t begin, size_t end) const {
+        const int32_t* ptrs[NUM_STATS];
+        for (int s = 0; s < NUM_STATS; ++s) ptrs[s] = cols[s].data() + begin;
+        return computeTotals(ptrs, end - begin);
+    }
+
+    // Day number of game i, and the whole date column
+    int32_t date(size_t i) const { return dates[i]; }
+    const int32_t* dateColumn() const { return dates.data(); }
+
+    // Bumped by every mutation; derived indexes compare it to know they are stale
+    uint64_t generation() const { return gen; }
+
+    // Bytes held by the columns and any built views, and by the views alone
+    size_t memoryBytes() const {
+        size_t n = dates.capacity();
+        for (const auto& c : cols) n += c.capacity();
+        n *= sizeof(int32_t);
+        for (const auto& c : dimCols) n += c.capacity() * sizeof(uint16_t);
+        return n + viewBytes();
+    }
+    size_t viewBytes() const {
+        size_t n = 0;
+        for (const auto& v : views) n += v.capacity() * sizeof(uint32_t);
+        return n;
+    }
+
+    // Drop the slack capacity left by appends, once loading is done
+    void shrinkToFit() {
+        for (auto& c : cols) c.shrink_to_fit();
+        for (auto& c : dimCols) c.shrink_to_fit();
+        dates.shrink_to_fit();
+    }
+
+private:
+    void pushColumns(int32_t date, const int32_t* stats, const uint16_t* dims) {
+        for (int s = 0; s < NUM_STATS; ++s) cols[s].push_back(stats[s]);
+        for (int k = 0; k < NUM_DIMS; ++k) dimCols[k].push_back(dims ? dims[k] : 0);
+        dates.push_back(date);
+        ++gen;
+    }
+
+    // Strict total order of a view: its key, then storage index
+    bool viewLess(int key, uint32_t a, uint32_t b) const {
+        if (key == VIEW_BY_DATE) {
+            if (dates[a] != dates[b]) return dates[a] < dates[b];
+        }
+        else if (cols[key][a] != cols[key][b]) {
+            return cols[key][a] > cols[key][b];
+        }
+        return a < b;
+    }
+
+    // Game idx was just appended: slot it into every built view
+    void viewsInsert(uint32_t idx) {
+        for (int k = 0; k < NUM_VIEWS; ++k) {
+            if (!viewBuilt[k]) continue;
+            vector<uint32_t>& v = views[k];
+            v.insert(lower_bound(v.begin(), v.end(), idx, [&](uint32_t a, uint32_t b) { return viewLess(k, a, b); }), idx);
+        }
+    }
+
+    // Game idx is about to be erased: drop it and renumber later games
+    void viewsErase(uint32_t idx) {
+        for (int k = 0; k < NUM_VIEWS; ++k) {
+            if (!viewBuilt[k]) continue;
+            vector<uint32_t>& v = views[k];
+            v.erase(lower_bound(v.begin(), v.end(), idx, [&](uint32_t a, uint32_t b) { return viewLess(k, a, b); }));
+            for (auto& e : v) e -= (e > idx);
+        }
+    }
+
+    void viewsDirty() {
+        for (int k = 0; k < NUM_VIEWS; ++k) viewBuilt[k] = false;
+    }
+
+    vector<int32_t> cols[NUM_STATS];
+    vector<uint16_t> dimCols[NUM_DIMS];
+    vector<int32_t> dates;
+    StatTotals running;
+    uint64_t gen = 0;
+    mutable vector<uint32_t> views[NUM_VIEWS];
+    mutable bool viewBuilt[NUM_VIEWS] = {};
+};
+
+// Totals over a slice of a player's games, as answered by DateQueryIndex
+struct QueryResult {
+    size_t games = 0;
+    int32_t firstDate = 0, lastDate = 0; // valid when games > 0
+    StatTotals totals;
+};
+
+// Prefix sums over a player's games in date order. Built lazily and rebuilt
+// whenever the GameStore generation has moved on (add/edit/delete/sort), so
+// any date-range or last-N aggregate costs two binary searches plus one
+// subtraction per stat.
+class DateQueryIndex {
+public:
+    // Games dated within [from, to], inclusive
+    QueryResult dateRange(const GameStore& store, int32_t from, int32_t to) const {
+        refresh(store);
+        size_t b = lower_bound(sortedDates.begin(), sortedDates.end(), from) - sortedDates.begin();
+        size_t e = upper_bound(sortedDates.begin(), sortedDates.end(), to) - sortedDates.begin();
+        return slice(b, max(b, e));
+    }
+
+    // The most recent n games (all games if there are fewer)
+    QueryResult lastGames(const GameStore& store, size_t n) const {
+        refresh(store);
+        size_t total = sortedDates.size();
+        return slice(total - min(n, total), total);
+    }
+
+    // Every game's date in date order, and the running sums of stat s over
+    // them (entry k sums the first k games)
+    const vector<int32_t>& dates(const GameStore& store) const {
+        refresh(store);
+        return sortedDates;
+    }
+    const vector<long long>& prefixSums(const GameStore& store, StatId s) const {
+        refresh(store);
+        return prefix[s];
+    }
+
+    // Bytes held by the built index
+    size_t memoryBytes() const {
+        size_t n = sortedDates.capacity() * sizeof(int32_t);
+        for (const auto& pre : prefix) n += pre.capacity() * sizeof(long long);
+        return n;
+    }
+
+private:
+    void refresh(const GameStore& store) const {
+        if (built && builtFor == store.generation()) return;
+        size_t n = store.size();
+        const vector<uint32_t>& order = store.sortedBy(GameStore::VIEW_BY_DATE);
+        const int32_t* dates = store.dateColumn();
+
+        sortedDates.resize(n);
+        for (size_t k = 0; k < n; ++k) sortedDates[k] = dates[order[k]];
+        for (int s = 0; s < NUM_STATS; ++s) {
+            const int32_t* col = store.column((StatId)s);
+            vector<long long>& pre = prefix[s];
+            pre.resize(n + 1);
+            pre[0] = 0;
+            for (size_t k = 0; k < n; ++k) pre[k + 1] = pre[k] + col[order[k]];
+        }
+        builtFor = store.generation();
+        built = true;
+    }
+
+    // Date-ordered positions [b, e)
+    QueryResult slice(size_t b, size_t e) const {
+        QueryResult r;
+        r.games = e - b;
+        if (r.games == 0) return r;
+        r.firstDate = sortedDates[b];
+        r.lastDate = sortedDates[e - 1];
+        for (int s = 0; s < NUM_STATS; ++s) r.totals.sum[s] = prefix[s][e] - prefix[s][b];
+        r.totals.derivePerRaw();
+        return r;
+    }
+
+    mutable bool built = false;
+    mutable uint64_t builtFor = 0;
+    mutable vector<int32_t> sortedDates;
+    mutable vector<long long> prefix[NUM_STATS];
+};
+
+// ======================================================
+// STRING POOL: interned names in arena blocks
+// ======================================================
+
+// 64-bit FNV-1a
+uint64_t hashString(string_view s) {
+    uint64_t h = 1469598103934665603ULL;
+    for (unsigned char c : s) { h ^= c; h *= 1099511628211ULL; }
+    return h;
+}
+
+// Append-only arena for strings that live as long as the program (player
+// names now, team and opponent names later). Strings are copied into large
+// blocks and handed out as string_views, which stay valid because blocks
+// never move or get freed. Equal strings share one copy, so reloading a
+// dataset allocates nothing new.
+class StringPool {
+public:
+    StringPool() {}
+    StringPool(const StringPool&) = delete;
+    StringPool& operator=(const StringPool&) = delete;
+
+    string_view intern(string_view s) {
+        if (s.empty()) return string_view();
+        lock_guard<mutex> g(lock);
+        if ((count + 1) * 2 > slots.size()) grow();
+        size_t mask = slots.size() - 1;
+        size_t i = hashString(s) & mask;
+        for (; slots[i].data(); i = (i + 1) & mask) {
+            if (slots[i] == s) return slots[i];
+        }
+        ++count;
+        return slots[i] = copyIn(s);
+    }
+
+    // Bytes held by the blocks and the table
+    size_t memoryBytes() {
+        lock_guard<mutex> g(lock);
+        return allocated + slots.capacity() * sizeof(string_view);
+    }
+
+private:
+    string_view copyIn(string_view s) {
+        const size_t BLOCK = 64 << 10;
+        char* at;
+        if (s.size() > BLOCK / 4) {
+            // Long strings get a block of their own so the current one is not wasted
+            blocks.emplace_back(new char[s.size()]);
+            allocated += s.size();
+            at = blocks.back().get();
+        }
+        else {
+            if (s.size() > left) {
+                blocks.emplace_back(new char[BLOCK]);
+                allocated += BLOCK;
+                next = blocks.back().get();
+                left = BLOCK;
+            }
+            at = next;
+            next += s.size();
+            left -= s.size();
+        }
+        memcpy(at, s.data(), s.size());
+        return string_view(at, s.size());
+    }
+
+    // Double the open-addressing table of interned strings
+    void grow() {
+        vector<string_view> old(slots.empty() ? 64 : slots.size() * 2);
+        old.swap(slots);
+        size_t mask = slots.size() - 1;
+        for (string_view s : old) {
+            if (!s.data()) continue;
+            size_t i = hashString(s) & mask;
+            while (slots[i].data()) i = (i + 1) & mask;
+            slots[i] = s;
+        }
+    }
+
+    mutex lock;
+    vector<unique_ptr<char[]>> blocks;
+    char* next = nullptr; // free space in the newest small-string block
+    size_t left = 0;
+    size_t allocated = 0; // bytes in blocks
+    vector<string_view> slots; // data() == nullptr marks an empty slot
+    size_t count = 0;
+};
+
+// Player names (and any other long-lived labels)
+StringPool namePool;
+
+// Dictionary of team names for the DIM_TEAM and DIM_OPPONENT columns. Id 0
+// is the empty name ("not recorded"). Names are interned in namePool, so
+// an id is looked up by the interned pointer. Adding takes a lock, since
+// the parallel CSV parser adds teams from several threads. The id table
+// grows a block at a time and blocks never move, so name() is a lock-free
+// read.
+class TeamDictionary {
+public:
+    static const uint32_t MAX_IDS = UINT16_MAX + 1;
+    static constexpr const char* FULL_ERROR = "more than 65535 team names";
+
+    TeamDictionary() { blocks[0].reset(new string_view[BLOCK_IDS]); }
+
+    // Set id to the id of name, adding it if new (0 for an empty name).
+    // False once all 65535 ids are taken and name is new.
+    bool idOf(string_view name, uint16_t& id) {
+        id = 0;
+        if (name.empty()) return true;
+        string_view s = namePool.intern(name);
+        lock_guard<mutex> g(lock);
+        auto it = ids.find(s.data());
+        if (it != ids.end()) { id = it->second; return true; }
+        uint32_t next = count.load(memory_order_relaxed);
+        if (next == MAX_IDS) return false;
+        auto& block = blocks[next / BLOCK_IDS];
+        if (!block) block.reset(new string_view[BLOCK_IDS]);
+        block[next % BLOCK_IDS] = s;
+        ids.emplace(s.data(), (uint16_t)next);
+        count.store(next + 1, memory_order_release);
+        id = (uint16_t)next;
+        return true;
+    }
+
+    string_view name(uint16_t id) const {
+        return id < count.load(memory_order_acquire) ? blocks[id / BLOCK_IDS][id % BLOCK_IDS] : string_view();
+    }
+
+    // Ids in use are [0, size())
+    uint32_t size() const { return count.load(memory_order_acquire); }
+
+    // Bytes held by the id blocks and the lookup map (the names are in namePool)
+    size_t memoryBytes() {
+        lock_guard<mutex> g(lock);
+        size_t used = (count.load(memory_order_relaxed) + BLOCK_IDS - 1) / BLOCK_IDS;
+        return sizeof(blocks) + used * BLOCK_IDS * sizeof(string_view) + ids.bucket_count() * sizeof(void*)
+            + ids.size() * (sizeof(pair<const char*, uint16_t>) + 2 * sizeof(void*));
+    }
+
+private:
+    static const uint32_t BLOCK_IDS = 1024;
+
+    mutex lock;
+    unique_ptr<string_view[]> blocks[MAX_IDS / BLOCK_IDS];
+    atomic<uint32_t> count{ 1 };
+    unordered_map<const char*, uint16_t> ids;
+};
+
+TeamDictionary teamDict;
+
+// Text of a venue id: "home", "away" or "" (not recorded)
+const char* const VENUE_NAMES[] = { "", "home", "away" };
+
+// Trim spaces and tabs from both ends
+string_view trimmed(string_view s) {
+    size_t b = s.find_first_not_of(" \t");
+    if (b == string_view::npos) return string_view();
+    return s.substr(b, s.find_last_not_of(" \t") - b + 1);
+}
+
+// Parse a venue name written by VENUE_NAMES (case-insensitive; "" = none)
+bool parseVenue(string_view text, uint16_t& venue) {
+    for (uint16_t v = 0; v < 3; ++v) {
+        string_view name = VENUE_NAMES[v];
+        if (text.size() != name.size()) continue;
+        bool same = true;
+        for (size_t i = 0; i < name.size() && same; ++i) same = tolower((unsigned char)text[i]) == name[i];
+        if (same) { venue = v; return true; }
+    }
+    return false;
+}
+
+// Display label of value v of dimension k: a team name or venue, "-" if not recorded
+string dimLabel(DimId k, uint16_t v) {
+    if (v == 0) return "-";
+    if (k == DIM_VENUE) return v == VENUE_HOME ? "Home" : "Away";
+    return string(teamDict.name(v));
+}
+
+// Holds a player's name and all their games
+struct Player {
+    string_view name; // interned in namePool
+    GameStore games;
+    DateQueryIndex byDate; // lazily built query index over games
+
+    // Order games are listed in: VIEW_STORAGE (entry order) or a GameStore view key
+    static const int VIEW_STORAGE = -1;
+    int view = VIEW_STORAGE;
+
+    uint64_t version = 0; // stamp of the last change (see REPORT CACHE)
+
+    Player() {}
+    explicit Player(string_view n) : name(namePool.intern(n)) {}
+
+    // Storage index of the k-th game in the current listing order
+    size_t shown(size_t k) const {
+        return view == VIEW_STORAGE ? k : games.sortedBy(view)[k];
+    }
+};
+
+// Open-addressing hash map from player name to index in a players vector.
+// Slots hold player indices (-1 = empty) and are probed linearly; the names
+// themselves are compared against the players vector, so no strings are
+// duplicated. The table is kept at most half full.
+class NameIndex {
+public:
+    void clear() { slots.clear(); count = 0; }
+
+    // Index of the player with this name, or -1
+    int find(const vector<Player>& players, string_view name) const {
+        if (slots.empty()) return -1;
+        size_t mask = slots.size() - 1;
+        for (size_t i = hashString(name) & mask;; i = (i + 1) & mask) {
+            int32_t idx = slots[i];
+            if (idx < 0) return -1;
+            if (players[idx].name == name) return idx;
+        }
+    }
+
+    // Register players[idx]; its name must not be indexed yet
+    void insert(const vector<Player>& players, int idx) {
+        if ((count + 1) * 2 > slots.size()) grow(players);
+        place(players, idx);
+        ++count;
+    }
+
+    size_t memoryBytes() const { return slots.capacity() * sizeof(int32_t); }
+
+    void rebuild(const vector<Player>& players) {
+        clear();
+        for (size_t i = 0; i < players.size(); ++i) insert(players, (int)i);
+    }
+
+private:
+    void place(const vector<Player>& players, int idx) {
+        size_t mask = slots.size() - 1;
+        size_t i = hashString(players[idx].name) & mask;
+        while (slots[i] >= 0) i = (i + 1) & mask;
+        slots[i] = idx;
+    }
+
+    void grow(const vector<Player>& players) {
+        vector<int32_t> old;
+        old.swap(slots);
+        slots.assign(old.empty() ? 16 : old.size() * 2, -1);
+        for (int32_t idx : old) {
+            if (idx >= 0) place(players, idx);
+        }
+    }
+
+    vector<int32_t> slots;
+    size_t count = 0;
+};
+
+// ======================================================
+// LEADERBOARDS: bounded top-K selection and the session board
+// ======================================================
+
+// What a leaderboard ranks by: a stat's total, its per-game average, or simplePER
+struct Ranking {
+    enum Kind { TOTAL, PER_GAME, PER };
+    Kind kind = TOTAL;
+    StatId stat = STAT_POINTS; // unused for PER
+};
+
+// A player's value under r from their totals over `games` games
+double rankValue(const Ranking& r, const StatTotals& t, size_t games) {
+    if (r.kind == Ranking::TOTAL) return (double)t.sum[r.stat];
+    if (games == 0) return 0.0;
+    return (double)(r.kind == Ranking::PER ? t.perRaw : t.sum[r.stat]) / (double)games;
+}
+
+// One game's value under r (per-game and total are the same for one game)
+long long gameValue(const Ranking& r, const int32_t* v) {
+    return r.kind == Ranking::PER ? perRawOf(v) : v[r.stat];
+}
+
+// A leaderboard entry. slot is the game's storage index for game boards.
+struct Ranked {
+    double value;
+    int player;
+    uint32_t slot;
+};
+
+// Best first; ties go to the earlier player, then the earlier game
+bool rankedBefore(const Ranked& a, const Ranked& b) {
+    if (a.value != b.value) return a.value > b.value;
+    if (a.player != b.player) return a.player < b.player;
+    return a.slot < b.slot;
+}
+
+// Keeps the k best entries offered so far in a heap whose top is the worst
+// one kept, so each offer is O(log k) and most are rejected in O(1).
+class TopK {
+public:
+    explicit TopK(size_t k) : k(k) { heap.reserve(k); }
+
+    // False if an entry with this value cannot make the list
+    bool admits(double value) const { return heap.size() < k || value >= heap.front().value; }
+
+    void offer(const Ranked& r) {
+        if (heap.size() < k) {
+            heap.push_back(r);
+            push_heap(heap.begin(), heap.end(), rankedBefore);
+        }
+        else if (k > 0 && rankedBefore(r, heap.front())) {
+            pop_heap(heap.begin(), heap.end(), rankedBefore);
+            heap.back() = r;
+            push_heap(heap.begin(), heap.end(), rankedBefore);
+        }
+    }
+
+    // The kept entries, best first
+    vector<Ranked> take() {
+        sort_heap(heap.begin(), heap.end(), rankedBefore);
+        return move(heap);
+    }
+
+private:
+    size_t k;
+    vector<Ranked> heap;
+};
+
+// Games added during this session ("tonight") and per-player totals over
+// them. Updated on every add, edit and delete, so "top 10 scorers tonight"
+// only looks at tonight's players and games, never the whole league.
+class SessionBoard {
+public:
+    void clear() { entries.clear(); lines.clear(); active.clear(); }
+
+    size_t games() const { return entries.size(); }
+
+    void added(int player, uint32_t slot, const int32_t* v) {
+        Entry e;
+        e.player = player;
+        e.slot = slot;
+        copy(v, v + NUM_STATS, e.v);
+        entries.push_back(e);
+        if ((size_t)player >= lines.size()) lines.resize(player + 1);
+        Line& line = lines[player];
+        if (!line.listed) { line.listed = true; active.push_back(player); }
+        line.totals.apply(v, 1);
+        ++line.games;
+    }
+
+    // Game `slot` of player now has values v; ignored if it is not a session game
+    void changed(int player, uint32_t slot, const int32_t* v) {
+        for (auto& e : entries) {
+            if (e.player != player || e.slot != slot) continue;
+            lines[player].totals.apply(e.v, -1);
+            lines[player].totals.apply(v, 1);
+            copy(v, v + NUM_STATS, e.v);
+            return;
+        }
+    }
+
+    // Game `slot` of player was erased; later games of that player moved down one slot
+    void erased(int player, uint32_t slot) {
+        size_t out = 0;
+        for (size_t i = 0; i < entries.size(); ++i) {
+            Entry& e = entries[i];
+            if (e.player == player && e.slot == slot) {
+                lines[player].totals.apply(e.v, -1);
+                --lines[player].games;
+                continue;
+            }
+            if (e.player == player && e.slot > slot) --e.slot;
+            entries[out++] = e;
+        }
+        entries.resize(out);
+    }
+
+    vector<Ranked> topPlayers(const Ranking& r, size_t k) const {
+        TopK top(k);
+        for (int p : active) {
+            const Line& line = lines[p];
+            if (line.games == 0) continue;
+            double v = rankValue(r, line.totals, line.games);
+            if (top.admits(v)) top.offer({ v, p, 0 });
+        }
+        return top.take();
+    }
+
+    vector<Ranked> topGames(const Ranking& r, size_t k) const {
+        TopK top(k);
+        for (const auto& e : entries) {
+            double v = (double)gameValue(r, e.v);
+            if (top.admits(v)) top.offer({ v, e.player, e.slot });
+        }
+        return top.take();
+    }
+
+private:
+    struct Entry {
+        int player;
+        uint32_t slot;
+        int32_t v[NUM_STATS];
+    };
+    struct Line {
+        StatTotals totals;
+        size_t games = 0;
+        bool listed = false; // already in active
+    };
+    vector<Entry> entries;
+    vector<Line> lines; // by player index
+    vector<int> active; // players with a line, in first-game order
+};
+
+// ======================================================
+// JOURNAL: append-only change log on top of a data file
+// ======================================================
+
+// "<datafile>.journal" holds the add-player, add-game, edit-game and
+// delete-game operations made since the data file was last written in
+// full. Loading the data file replays it, so saving a change only appends
+// that change. Layout (little-endian):
+//   JournalHeader
+//   records: uint32 payload size, uint32 FNV-1a checksum, payload
+// A payload is a JournalOp byte followed by its fields. The header holds a
+// hash of the data file the journal applies to, so a journal left behind by
+// an older version of the file is recognised and ignored.
+// Version 2 game records end with the game's NUM_DIMS uint16 dimensions;
+// their team ids are bound to names by JOP_TEAM records earlier in the
+// journal. Version 1 journals, without either, are still replayed.
+const char JOURNAL_MAGIC[4] = { 'B', 'J', 'N', 'L' };
+const uint32_t JOURNAL_VERSION = 2;
+
+struct JournalHeader {
+    char magic[4];
+    uint32_t version;
+    uint64_t baseHash; // hashFile() of the data file
+};
+
+static_assert(sizeof(JournalHeader) == 16, "journal header layout");
+
+enum JournalOp : uint8_t { JOP_ADD_PLAYER = 1, JOP_ADD_GAME, JOP_EDIT_GAME, JOP_DELETE_GAME, JOP_TEAM };
+
+// 32-bit FNV-1a, the record checksum
+uint32_t checksum32(const char* p, size_t n) {
+    uint32_t h = 2166136261u;
+    for (size_t i = 0; i < n; ++i) { h ^= (unsigned char)p[i]; h *= 16777619u; }
+    return h;
+}
+
+string journalFileFor(const string& dataFile) { return dataFile + ".journal"; }
+
+// Flush a stdio stream and force its data to the storage device
+bool flushToDisk(FILE* f) {
+    if (fflush(f) != 0) return false;
+#ifdef _WIN32
+    return _commit(_fileno(f)) == 0;
+#else
+    return fsync(fileno(f)) == 0;
+#endif
+}
+
+// Writer for an open journal. Operations are encoded into a pending buffer
+// and a committer thread writes and fsyncs whatever has accumulated, so
+// records appended while an fsync is in progress share the next one
+// (group commit). sync() waits until everything appended so far is durable.
+class Journal {
+public:
+    Journal() {}
+    Journal(const Journal&) = delete;
+    Journal& operator=(const Journal&) = delete;
+    ~Journal() { close(); }
+
+    bool isOpen() const { return file != nullptr; }
+    const string& dataFile() const { return data; }
+    uint64_t baseHash() const { return base; }
+
+    // Bytes in the journal file, including records not yet committed
+    uint64_t size() const {
+        lock_guard<mutex> g(lock);
+        return full;
+    }
+
+    // Journal the changes to dataFile. With keep == 0 a new journal for a
+    // data file with hash baseHash replaces any old one; otherwise the
+    // existing journal is continued after its first keep bytes.
+    bool open(const string& dataFile, uint64_t baseHash, uint64_t keep, string& error) {
+        close();
+        string path = journalFileFor(dataFile);
+        if (keep > 0) {
+            error_code ec;
+            filesystem::resize_file(path, keep, ec); // drops a torn record at the end
+            if (ec) { error = ec.message(); return false; }
+            file = fopen(path.c_str(), "ab");
+        }
+        else {
+            file = fopen(path.c_str(), "wb");
+            JournalHeader h = {};
+            memcpy(h.magic, JOURNAL_MAGIC, sizeof(h.magic));
+            h.version = JOURNAL_VERSION;
+            h.baseHash = baseHash;
+            if (file && (fwrite(&h, sizeof(h), 1, file) != 1 || !flushToDisk(file))) {
+                fclose(file);
+                file = nullptr;
+            }
+            keep = sizeof(JournalHeader);
+        }
+        if (!file) { error = strerror(errno); return false; }
+        data = dataFile;
+        base = baseHash;
+        full = keep;
+        appended = durable = 0;
+        failed = stopping = false;
+        named.assign(TeamDictionary::MAX_IDS, false);
+        named[0] = true; // id 0 is always the empty name
+        committer = thread([this]() { commitLoop(); });
+        return true;
+    }
+
+    // Commit outstanding records and close the file
+    void close() {
+        if (!file) return;
+        {
+            lock_guard<mutex> g(lock);
+            stopping = true;
+        }
+        wake.notify_one();
+        committer.join();
+        fclose(file);
+        file = nullptr;
+        data.clear();
+    }
+
+    void addPlayer(string_view name) {
+        string rec(1, (char)JOP_ADD_PLAYER);
+        rec.append(name.data(), name.size());
+        append(rec);
+    }
+
+    void addGame(int player, const GameStats& g) { appendGame(gameRecord(JOP_ADD_GAME, player, 0, g), g); }
+
+    void editGame(int player, size_t slot, const GameStats& g) {
+        appendGame(gameRecord(JOP_EDIT_GAME, player, (uint32_t)slot, g), g);
+    }
+
+    void deleteGame(int player, size_t slot) {
+        string rec(1, (char)JOP_DELETE_GAME);
+        putU32(rec, (uint32_t)player);
+        putU32(rec, (uint32_t)slot);
+        append(rec);
+    }
+
+    // Wait until every record appended so far is on disk; false if a
+    // write or fsync failed
+    bool sync() {
+        unique_lock<mutex> g(lock);
+        uint64_t target = appended;
+        done.wait(g, [&]() { return durable >= target || failed; });
+        return !failed;
+    }
+
+private:
+    static void putU32(string& rec, uint32_t v) { rec.append((const char*)&v, sizeof(v)); }
+
+    static string gameRecord(JournalOp op, int player, uint32_t slot, const GameStats& g) {
+        string rec(1, (char)op);
+        putU32(rec, (uint32_t)player);
+        if (op == JOP_EDIT_GAME) putU32(rec, slot);
+        putU32(rec, (uint32_t)g.date);
+        for (int s = 0; s < NUM_STATS; ++s) putU32(rec, (uint32_t)(g.*STAT_FIELDS[s]));
+        for (int k = 0; k < NUM_DIMS; ++k) {
+            uint16_t d = (uint16_t)(g.*DIM_FIELDS[k]);
+            rec.append((const char*)&d, sizeof(d));
+        }
+        return rec;
+    }
+
+    void append(const string& payload) {
+        {
+            lock_guard<mutex> g(lock);
+            appendLocked(payload);
+        }
+        wake.notify_one();
+    }
+
+    // A game record, preceded by a JOP_TEAM record for each of its teams
+    // not yet named in this journal
+    void appendGame(const string& payload, const GameStats& game) {
+        {
+            lock_guard<mutex> g(lock);
+            for (uint16_t id : { (uint16_t)game.team, (uint16_t)game.opponent }) {
+                if (named[id]) continue;
+                named[id] = true;
+                string rec(1, (char)JOP_TEAM);
+                rec.append((const char*)&id, sizeof(id));
+                string_view name = teamDict.name(id);
+                rec.append(name.data(), name.size());
+                appendLocked(rec);
+            }
+            appendLocked(payload);
+        }
+        wake.notify_one();
+    }
+
+    void appendLocked(const string& payload) {
+        putU32(pending, (uint32_t)payload.size());
+        putU32(pending, checksum32(payload.data(), payload.size()));
+        pending += payload;
+        full += 2 * sizeof(uint32_t) + payload.size();
+        ++appended;
+    }
+
+    void commitLoop() {
+        string batch;
+        unique_lock<mutex> g(lock);
+        for (;;) {
+            wake.wait(g, [&]() { return !pending.empty() || stopping; });
+            if (pending.empty()) return; // stopping with nothing left
+            batch.swap(pending);
+            uint64_t upTo = appended;
+            g.unlock();
+            bool ok;
+            {
+                BSTATS_PROBE(PROBE_JOURNAL_COMMIT);
+                BSTATS_BYTES(PROBE_JOURNAL_COMMIT, 0, batch.size());
+                ok = fwrite(batch.data(), 1, batch.size(), file) == batch.size() && flushToDisk(file);
+            }
+            batch.clear();
+            g.lock();
+            if (ok) durable = upTo;
+            else failed = true;
+            done.notify_all();
+        }
+    }
+
+    FILE* file = nullptr;
+    string data;               // the data file this journal belongs to
+    uint64_t base = 0;         // and its hash
+    mutable mutex lock;        // guards everything below
+    condition_variable wake;   // committer: records pending or stopping
+    condition_variable done;   // sync(): a commit finished
+    string pending;            // encoded records not yet written
+    uint64_t full = 0;         // journal file size once pending is written
+    uint64_t appended = 0, durable = 0; // record counts
+    bool failed = false, stopping = false;
+    vector<bool> named;        // teamDict ids with a JOP_TEAM record since open()
+    thread committer;
+};
+
+// ======================================================
+// REPORT CACHE: league-wide results kept until the data changes
+// ======================================================
+
+// Every write stamps the player it changes, and the league, with the next
+// value of one process-wide counter. Stamps never repeat, so a result built
+// at some stamp stays valid for exactly as long as the stamp is unchanged.
+uint64_t nextVersion() {
+    static atomic<uint64_t> counter(0);
+    return ++counter;
+}
+
+// One report for one set of parameters: the whole result as of league
+// version `version`, plus each player's share of it as of that player's
+// version, so a rebuild only redoes the players that changed.
+template <typename Part>
+struct CachedReport {
+    uint64_t version = 0; // 0 = never built
+    Part result;
+    vector<uint64_t> partVersions; // by player index; 0 = not built
+    vector<Part> parts;
+
+    // Indices of the players whose part is missing or out of date. They are
+    // marked current, so the caller must rebuild every one it is given.
+    vector<size_t> stale(const vector<Player>& players) {
+        partVersions.resize(players.size(), 0);
+        parts.resize(players.size());
+        vector<size_t> out;
+        for (size_t i = 0; i < players.size(); ++i) {
+            if (partVersions[i] == players[i].version) continue;
+            partVersions[i] = players[i].version;
+            out.push_back(i);
+        }
+        return out;
+    }
+};
+
+// Cached quick summaries and leaderboards keyed by report and parameters.
+// Used from the menus and the command line only, so it takes no lock.
+struct ReportCache {
+    unordered_map<string, CachedReport<string>> text;
+    unordered_map<string, CachedReport<vector<Ranked>>> boards;
+
+    void clear() { text.clear(); boards.clear(); }
+};
+
+// ======================================================
+// LIVE SNAPSHOTS: copy-on-write reads while games are entered
+// ======================================================
+
+// Read side of a League for reports running on other threads while games
+// are being entered (the live report server, see LIVE SERVER). Each player
+// has a slot holding an immutable copy of the player (name and games, listed
+// in storage order) plus the games appended since that copy, as a shared
+// list, newest first. Appending a game under the League's write lock only
+// links one node onto the list. Once the list outgrows a quarter of the copy
+// the writer folds it into a new copy, so appends cost O(1) amortized. Edits
+// and deletes copy the player. A reader that finds a list folds it itself
+// and swaps the result into the slot, so later readers reuse it.
+//
+// Readers never take the League's lock. The slot loads and stores go through
+// the standard atomic shared_ptr functions, which libstdc++ implements with
+// a small pool of mutexes, so this is not lock-free: a reader can briefly
+// wait on a writer swapping the same slot. An old copy is freed when its
+// last reader drops it. The slot list is itself immutable and is replaced
+// when a player is added. Each player a reader sees is complete as of some
+// write, but two players can be from different moments.
+//
+// Copies exist only while live access is on (start() to stop()). Readers
+// should stick to the reports that use only the running totals and columns
+// (totals, averages, best games, metrics); sorted listings and date queries
+// build indexes on first use and belong to the writer's copy.
+class LiveStore {
+public:
+    using Snapshot = shared_ptr<const Player>;
+
+    bool active() const { return atomic_load(&roster) != nullptr; }
+
+    // Publish every player; later writes republish the player they change
+    void start(const vector<Player>& players) {
+        auto r = make_shared<Roster>();
+        r->slots.reserve(players.size());
+        for (const auto& p : players) {
+            r->byName.emplace(p.name, (uint32_t)r->slots.size());
+            r->slots.push_back(make_shared<Slot>(Slot{ entryOf(p) }));
+        }
+        atomic_store(&roster, shared_ptr<const Roster>(move(r)));
+        on = true;
+    }
+
+    void stop() {
+        on = false;
+        atomic_store(&roster, shared_ptr<const Roster>());
+    }
+
+    size_t size() const {
+        auto r = atomic_load(&roster);
+        return r ? r->slots.size() : 0;
+    }
+
+    // Index of the player with this name, or -1
+    int find(string_view name) const {
+        auto r = atomic_load(&roster);
+        if (!r) return -1;
+        auto it = r->byName.find(name);
+        return it == r->byName.end() ? -1 : (int)it->second;
+    }
+
+    // The current copy of player idx; null if live access is off or idx is unknown
+    Snapshot read(size_t idx) const {
+        auto r = atomic_load(&roster);
+        if (!r || idx >= r->slots.size()) return Snapshot();
+        Slot& slot = *r->slots[idx];
+        auto e = atomic_load(&slot.entry);
+        if (!e->tail) return e->base;
+        auto folded = make_shared<const Entry>(Entry{ withTail(*e), nullptr, 0, e->version });
+        atomic_compare_exchange_strong(&slot.entry, &e, folded);
+        return folded->base;
+    }
+
+    // Writer side, called by League under its write lock.
+    // p changed in place: copy it.
+    void publish(size_t idx, const Player& p) {
+        if (!on) return;
+        auto r = atomic_load(&roster);
+        if (r && idx < r->slots.size()) atomic_store(&r->slots[idx]->entry, entryOf(p));
+    }
+
+    // p gained n games at the end of its storage
+    void appended(size_t idx, const Player& p, size_t n = 1) {
+        if (!on) return;
+        auto r = atomic_load(&roster);
+        if (!r || idx >= r->slots.size()) return;
+        Slot& slot = *r->slots[idx];
+        auto e = atomic_load(&slot.entry);
+        size_t tailGames = e->tailGames + n;
+        if (tailGames > max(MIN_FOLD, e->base->games.size() / 4)) {
+            atomic_store(&slot.entry, entryOf(p));
+            return;
+        }
+        shared_ptr<const Delta> tail = e->tail;
+        for (size_t k = p.games.size() - n; k < p.games.size(); ++k) tail = make_shared<const Delta>(Delta{ p.games[k], move(tail) });
+        atomic_store(&slot.entry, make_shared<const Entry>(Entry{ e->base, move(tail), tailGames, p.version }));
+    }
+
+    void added(const Player& p) {
+        if (!on) return;
+        auto r = atomic_load(&roster);
+        if (!r) return;
+        auto next = make_shared<Roster>(*r);
+        next->byName.emplace(p.name, (uint32_t)next->slots.size());
+        next->slots.push_back(make_shared<Slot>(Slot{ entryOf(p) }));
+        atomic_store(&roster, shared_ptr<const Roster>(move(next)));
+    }
+
+    // Republish whatever changed in players without the calls above (loads,
+    // merges, sorting): players whose version differs from their copy, and
+    // new players. Starts over if the roster no longer lines up.
+    void sync(const vector<Player>& players) {
+        auto r = atomic_load(&roster);
+        bool same = r && r->slots.size() <= players.size();
+        for (size_t i = 0; same && i < r->slots.size(); ++i) {
+            same = atomic_load(&r->slots[i]->entry)->base->name == players[i].name;
+        }
+        if (!same) { start(players); return; }
+        for (size_t i = 0; i < r->slots.size(); ++i) {
+            if (atomic_load(&r->slots[i]->entry)->version != players[i].version) publish(i, players[i]);
+        }
+        for (size_t i = r->slots.size(); i < players.size(); ++i) added(players[i]);
+    }
+
+private:
+    // The list is folded once it holds more than this many games and more
+    // than a quarter of the copy's
+    static const size_t MIN_FOLD = 16;
+
+    struct Delta {
+        GameStats game;
+        shared_ptr<const Delta> prev;
+    };
+    struct Entry {
+        Snapshot base;
+        shared_ptr<const Delta> tail; // games appended after base, newest first
+        size_t tailGames;
+        uint64_t version; // Player::version this entry reflects
+    };
+    struct Slot { shared_ptr<const Entry> entry; };
+    struct Roster {
+        vector<shared_ptr<Slot>> slots;
+        unordered_map<string_view, uint32_t> byName; // names are interned
+    };
+
+    static shared_ptr<const Entry> entryOf(const Player& p) {
+        auto s = make_shared<Player>();
+        s->name = p.name;
+        s->games = p.games;
+        return make_shared<const Entry>(Entry{ move(s), nullptr, 0, p.version });
+    }
+
+    static Snapshot withTail(const Entry& e) {
+        vector<const GameStats*> games;
+        games.reserve(e.tailGames);
+        for (const Delta* d = e.tail.get(); d; d = d->prev.get()) games.push_back(&d->game);
+        auto s = make_shared<Player>();
+        s->name = e.base->name;
+        s->games = e.base->games;
+        s->games.reserve(s->games.size() + games.size());
+        for (size_t i = games.size(); i-- > 0;) s->games.push_back(*games[i]);
+        return s;
+    }
+
+    shared_ptr<const Roster> roster;
+    bool on = false; // live access is on; read and written by the writer only
+};
+
+struct PlayerPager;
+
+// Box-score rows for many players, stored by column like GameStore so batch
+// validation streams through each stat once (see BATCH INGESTION)
+struct GameBatch {
+    vector<int32_t> player; // index into League::players
+    vector<int32_t> date;
+    vector<int32_t> cols[NUM_STATS];
+    vector<uint16_t> dimCols[NUM_DIMS];
+
+    size_t size() const { return player.size(); }
+
+    void reserve(size_t n) {
+        player.reserve(n);
+        date.reserve(n);
+        for (auto& c : cols) c.reserve(n);
+        for (auto& c : dimCols) c.reserve(n);
+    }
+
+    // Add a row; dims may be nullptr (none recorded)
+    void add(int32_t p, int32_t d, const int32_t* v, const uint16_t* dims = nullptr) {
+        player.push_back(p);
+        date.push_back(d);
+        for (int s = 0; s < NUM_STATS; ++s) cols[s].push_back(v[s]);
+        for (int k = 0; k < NUM_DIMS; ++k) dimCols[k].push_back(dims ? dims[k] : 0);
+    }
+};
+
+// All players plus the name index that is kept in sync with them. Players are
+// only ever added through add()/merge(), so indices stay stable.
+// Writes go through the League methods below. They take the write lock, so
+// stations entering games on several threads are applied (and journaled)
+// one at a time, and they republish the changed player for live readers.
+struct League {
+    vector<Player> players;
+    NameIndex byName;
+    SessionBoard session;
+    Journal journal; // open while interactive changes are journaled
+    // Set while an archive is open lazily: players it has not paged in yet
+    // have no games in memory (see LAZY LOADING)
+    shared_ptr<PlayerPager> pager;
+    LiveStore live;  // copies for report threads while live access is on
+    mutex writeLock; // held by every write below
+    uint64_t version = nextVersion(); // stamp of the last change to any player
+    ReportCache cache;
+
+    int find(string_view name) const { return byName.find(players, name); }
+
+    // Add a player with no games; the name must not exist yet
+    int add(string_view name) {
+        lock_guard<mutex> lock(writeLock);
+        return insert(Player(name));
+    }
+
+    // Add p, or append its games to the existing player with the same name.
+    // Returns the player's index.
+    int merge(Player&& p) {
+        lock_guard<mutex> lock(writeLock);
+        int idx = find(p.name);
+        if (idx >= 0) {
+            players[idx].games.appendAll(p.games);
+            touch(idx);
+            live.publish(idx, players[idx]);
+            return idx;
+        }
+        return insert(move(p));
+    }
+
+    // Interactive edits go through these so the session board and the
+    // journal stay in sync; commit() then makes the journaled changes durable
+    int create(string_view name) {
+        lock_guard<mutex> lock(writeLock);
+        if (journal.isOpen()) journal.addPlayer(name);
+        return insert(Player(name));
+    }
+
+    void addGame(int idx, const GameStats& g) {
+        lock_guard<mutex> lock(writeLock);
+        if (journal.isOpen()) journal.addGame(idx, g);
+        GameStore& games = players[idx].games;
+        games.push_back(g);
+        int32_t v[NUM_STATS];
+        games.values(games.size() - 1, v);
+        session.added(idx, (uint32_t)games.size() - 1, v);
+        touch(idx);
+        live.appended(idx, players[idx]);
+    }
+
+    // Append every row of batch whose bit in rejected is clear, under one
+    // lock. Each player's storage is reserved once for all of its rows.
+    // Returns the number of rows added.
+    size_t addGames(const GameBatch& batch, const vector<uint64_t>& rejected) {
+        lock_guard<mutex> lock(writeLock);
+        vector<uint32_t> rows(players.size(), 0);
+        size_t n = batch.size(), added = 0;
+        for (size_t i = 0; i < n; ++i) {
+            if (!((rejected[i >> 6] >> (i & 63)) & 1)) ++rows[batch.player[i]];
+        }
+        for (size_t p = 0; p < rows.size(); ++p) {
+            if (rows[p]) players[p].games.reserve(players[p].games.size() + rows[p]);
+        }
+        int32_t v[NUM_STATS];
+        uint16_t d[NUM_DIMS];
+        for (size_t i = 0; i < n; ++i) {
+            if ((rejected[i >> 6] >> (i & 63)) & 1) continue;
+            int idx = batch.player[i];
+            GameStore& games = players[idx].games;
+            for (int s = 0; s < NUM_STATS; ++s) v[s] = batch.cols[s][i];
+            for (int k = 0; k < NUM_DIMS; ++k) d[k] = batch.dimCols[k][i];
+            games.append(batch.date[i], v, d);
+            if (journal.isOpen()) journal.addGame(idx, games[games.size() - 1]);
+            session.added(idx, (uint32_t)games.size() - 1, v);
+            ++added;
+        }
+        for (size_t p = 0; p < rows.size(); ++p) {
+            if (!rows[p]) continue;
+            touch((int)p);
+            live.appended(p, players[p], rows[p]);
+        }
+        return added;
+    }
+
+    void updateGame(int idx, size_t slot, const GameStats& g) {
+        lock_guard<mutex> lock(writeLock);
+        if (journal.isOpen()) journal.editGame(idx, slot, g);
+        GameStore& games = players[idx].games;
+        games.set(slot, g);
+        int32_t v[NUM_STATS];
+        games.values(slot, v);
+        session.changed(idx, (uint32_t)slot, v);
+        touch(idx);
+        live.publish(idx, players[idx]);
+    }
+
+    void removeGame(int idx, size_t slot) {
+        lock_guard<mutex> lock(writeLock);
+        if (journal.isOpen()) journal.deleteGame(idx, slot);
+        players[idx].games.erase(slot);
+        session.erased(idx, (uint32_t)slot);
+        touch(idx);
+        live.publish(idx, players[idx]);
+    }
+
+    bool commit() { return !journal.isOpen() || journal.sync(); }
+
+    // Bring the live copies up to date with changes made without the
+    // methods above, starting live access if it is off
+    void syncLive() {
+        lock_guard<mutex> lock(writeLock);
+        live.sync(players);
+    }
+
+    void clear() {
+        lock_guard<mutex> lock(writeLock);
+        players.clear();
+        byName.clear();
+        session.clear();
+        pager.reset();
+        live.stop();
+        cache.clear();
+        version = nextVersion();
+    }
+
+    // Record a change to players[idx] made without the methods above
+    // (journal replay, generated leagues)
+    void touch(int idx) { players[idx].version = version = nextVersion(); }
+
+private:
+    int insert(Player&& p) {
+        players.push_back(move(p));
+        touch((int)players.size() - 1);
+        byName.insert(players, (int)players.size() - 1);
+        live.added(players.back());
+        return (int)players.size() - 1;
+    }
+};
+
+// Games of player idx, including ones still on disk (defined with the pager)
+size_t gameCount(const League& league, int idx);
+
+// ======================================================
+// OUTPUT SINK: buffered console output
+// ======================================================
+
+// Stream buffer that collects output in one large block and hands it to a
+// C stdio stream only when the block fills up or the stream is flushed.
+class SinkBuffer : public streambuf {
+public:
+    SinkBuffer(FILE* f, size_t size) : file(f), buf(size) {
+        setp(buf.data(), buf.data() + buf.size());
+    }
+
+protected:
+    int_type overflow(int_type c) override {
+        if (drain() != 0) return traits_type::eof();
+        if (!traits_type::eq_int_type(c, traits_type::eof())) {
+            *pptr() = traits_type::to_char_type(c);
+            pbump(1);
+        }
+        return traits_type::not_eof(c);
+    }
+
+    streamsize xsputn(const char* s, streamsize n) override {
+        // Pieces larger than the whole buffer bypass it
+        if (n > epptr() - pptr() && (size_t)n >= buf.size()) {
+            if (drain() != 0) return 0;
+            return (streamsize)write(s, (size_t)n);
+        }
+        return streambuf::xsputn(s, n);
+    }
+
+    int sync() override { return drain() == 0 && fflush(file) == 0 ? 0 : -1; }
+
+private:
+    int drain() {
+        size_t n = pptr() - pbase();
+        setp(buf.data(), buf.data() + buf.size());
+        return n == 0 || write(buf.data(), n) == n ? 0 : -1;
+    }
+
+    size_t write(const char* s, size_t n) {
+        BSTATS_PROBE(PROBE_OUTPUT);
+        BSTATS_BYTES(PROBE_OUTPUT, 0, n);
+        return fwrite(s, 1, n, file);
+    }
+
+    FILE* file;
+    vector<char> buf;
+};
+
+// An ostream over a SinkBuffer. Everything the program prints goes through
+// one of these; output is only written out at report boundaries (flush) or
+// when the program waits for console input (cin is tied to console).
+class OutputSink : public ostream {
+public:
+    OutputSink(FILE* f, size_t bufferSize) : ostream(nullptr), sink(f, bufferSize) { rdbuf(&sink); }
+    ~OutputSink() { flush(); }
+
+    // Quiet mode (-q) drops confirmation messages written through status()
+    static bool quiet;
+
+private:
+    SinkBuffer sink;
+};
+
+bool OutputSink::quiet = false;
+
+OutputSink console(stdout, 1 << 20);
+OutputSink diagnostics(stderr, 1 << 12);
+
+// Writes to this stream are discarded
+ostream nullStream(nullptr);
+
+// Stream for progress/confirmation messages, e.g. "Saved ...". Errors are
+// written to log directly so quiet mode never hides them.
+ostream& status(ostream& log) {
+    return OutputSink::quiet ? nullStream : log;
+}
+
+// ======================================================
+// HELPER I/O UTILITIES
+// ======================================================
+
+// Read an entire line after using >> for ints; used to sync newline
+void clearInputLine() {
+    string dummy;
+    getline(cin, dummy);
+}
+
+// Read an integer safely with prompt
+int readInt(const string& prompt) {
+    int x;
+    while (true) {
+        console << prompt;
+        if (cin >> x) {
+            clearInputLine();
+            return x;
+        }
+        else {
+            console << "Invalid integer. Try again.\n\n";
+            cin.clear();
+            clearInputLine();
+        }
+    }
+}
+
+// Read a string line (including spaces)
+string readLine(const string& prompt) {
+    console << prompt;
+    string s;
+    getline(cin, s);
+    return s;
+}
+
+// Read a YYYY-MM-DD date, re-prompting until it is a real calendar date
+int32_t readDate(const string& prompt) {
+    int32_t day;
+    while (!parseDate(readLine(prompt), day)) {
+        console << "Invalid date; use YYYY-MM-DD (e.g. 2025-01-31).\n\n";
+    }
+    return day;
+}
+
+// ======================================================
+// CALCULATION HELPERS
+// ======================================================
+
+// Field goal % (returns double, 0 if attempts = 0)
+double pct(long long made, long long att) {
+    if (att == 0) return 0.0;
+    return (double)made / att * 100.0;
+}
+
+// Simple classroom-style Player Efficiency Rating (PER)
+// This is NOT the NBA's PER; it's a simplified, transparent formula useful for learning.
+// Example formula used here:
+//   raw = points + rebounds + assists + steals + blocks
+//         - ( (fga - fgm) + (fta - ftm) )   // punishment for missed shots
+// Then normalized by games (if passed gamesCount) to get per-game value.
+// The raw total is kept up to date by GameStore (see perRawOf), so this is O(1).
+double simplePER(const Player& p) {
+    if (p.games.empty()) return 0.0;
+    return (double)p.games.totals().perRaw / (double)p.games.size();
+}
+
+// ======================================================
+// METRICS ENGINE: advanced metrics declared once, gathered in one pass
+// ======================================================
+
+// Everything a metric can be computed from. The totals-based intermediates
+// (misses, scoring attempts) are derived once; the per-game accumulators are
+// filled by a single pass over the columns, shared by every metric that
+// needs one.
+struct MetricInputs {
+    StatTotals totals;
+    size_t games = 0;
+    long long missedFG = 0, missedFT = 0;
+    double scoringAttempts = 0; // FGA + 0.44 * FTA
+    // Per-game accumulators
+    double bestGameScore = 0;
+    long long doubleDoubles = 0, tripleDoubles = 0;
+};
+
+// One metric: perGame is set when it needs the column pass rather than
+// just the running totals
+struct MetricDef {
+    const char* key;
+    const char* label;
+    bool perGame;
+    int decimals;
+    double (*value)(const MetricInputs&);
+};
+
+double safeRatio(double num, double den) { return den == 0 ? 0.0 : num / den; }
+
+// Hollinger's game score without the stats this program does not track
+// (offensive rebounds, fouls, turnovers); rebounds use the average of the
+// ORB and DRB weights. Linear, so it works on a game or on totals.
+template <typename T>
+double gameScoreOf(const T* v) {
+    return v[STAT_POINTS] + 0.4 * v[STAT_FGM] - 0.7 * v[STAT_FGA] - 0.4 * ((double)v[STAT_FTA] - v[STAT_FTM])
+        + 0.5 * v[STAT_REBOUNDS] + v[STAT_STEALS] + 0.7 * v[STAT_ASSISTS] + 0.7 * v[STAT_BLOCKS];
+}
+
+// The metric table; reports and the command line work from this alone
+constexpr MetricDef METRICS[] = {
+    { "ts", "True shooting %", false, 2, [](const MetricInputs& m) {
+        return safeRatio(100.0 * m.totals.sum[STAT_POINTS], 2.0 * m.scoringAttempts); } },
+    { "efg", "Effective FG %", false, 2, [](const MetricInputs& m) {
+        return safeRatio(100.0 * (m.totals.sum[STAT_FGM] + 0.5 * m.totals.sum[STAT_3PM]), (double)m.totals.sum[STAT_FGA]); } },
+    { "3par", "3-point attempt rate %", false, 2, [](const MetricInputs& m) {
+        return safeRatio(100.0 * m.totals.sum[STAT_3PA], (double)m.totals.sum[STAT_FGA]); } },
+    { "ftr", "Free throw rate (FTA/FGA)", false, 3, [](const MetricInputs& m) {
+        return safeRatio((double)m.totals.sum[STAT_FTA], (double)m.totals.sum[STAT_FGA]); } },
+    { "usage", "Usage proxy (FGA + 0.44 FTA per game)", false, 2, [](const MetricInputs& m) {
+        return safeRatio(m.scoringAttempts, (double)m.games); } },
+    { "misses", "Missed shots per game", false, 2, [](const MetricInputs& m) {
+        return safeRatio((double)(m.missedFG + m.missedFT), (double)m.games); } },
+    { "per", "Simple PER", false, 2, [](const MetricInputs& m) {
+        return safeRatio((double)m.totals.perRaw, (double)m.games); } },
+    { "gmsc", "Game score per game", false, 2, [](const MetricInputs& m) {
+        return safeRatio(gameScoreOf(m.totals.sum), (double)m.games); } },
+    { "bestgmsc", "Best game score", true, 2, [](const MetricInputs& m) { return m.bestGameScore; } },
+    { "dd", "Double-doubles", true, 0, [](const MetricInputs& m) { return (double)m.doubleDoubles; } },
+    { "td", "Triple-doubles", true, 0, [](const MetricInputs& m) { return (double)m.tripleDoubles; } },
+};
+const int NUM_METRICS = (int)(sizeof(METRICS) / sizeof(METRICS[0]));
+
+// A set of metrics, one bit per METRICS entry
+using MetricMask = uint32_t;
+const MetricMask ALL_METRICS = (1u << NUM_METRICS) - 1;
+
+// Gather the inputs for the metrics in mask. Totals-only metrics are O(1)
+// from the running totals; if any metric needs per-game data, one pass over
+// the columns updates every per-game accumulator together.
+MetricInputs gatherMetrics(const GameStore& g, MetricMask mask) {
+    MetricInputs m;
+    m.totals = g.totals();
+    m.games = g.size();
+    const long long* t = m.totals.sum;
+    m.missedFG = t[STAT_FGA] - t[STAT_FGM];
+    m.missedFT = t[STAT_FTA] - t[STAT_FTM];
+    m.scoringAttempts = t[STAT_FGA] + 0.44 * t[STAT_FTA];
+
+    bool pass = false;
+    for (int i = 0; i < NUM_METRICS; ++i) {
+        if ((mask >> i & 1) && METRICS[i].perGame) pass = true;
+    }
+    if (!pass || m.games == 0) return m;
+
+    const int32_t* col[NUM_STATS];
+    for (int s = 0; s < NUM_STATS; ++s) col[s] = g.column((StatId)s);
+    double best = -1e300;
+    int32_t v[NUM_STATS];
+    for (size_t i = 0; i < m.games; ++i) {
+        for (int s = 0; s < NUM_STATS; ++s) v[s] = col[s][i];
+        int tens = (v[STAT_POINTS] >= 10) + (v[STAT_REBOUNDS] >= 10) + (v[STAT_ASSISTS] >= 10)
+            + (v[STAT_STEALS] >= 10) + (v[STAT_BLOCKS] >= 10);
+        m.doubleDoubles += tens >= 2;
+        m.tripleDoubles += tens >= 3;
+        best = max(best, gameScoreOf(v));
+    }
+    m.bestGameScore = best;
+    return m;
+}
+
+// Parse a comma-separated list of metric keys ("all" for every metric)
+bool parseMetrics(string_view list, MetricMask& mask) {
+    mask = 0;
+    while (!list.empty()) {
+        size_t comma = list.find(',');
+        string_view key = list.substr(0, comma);
+        list = comma == string_view::npos ? string_view() : list.substr(comma + 1);
+        if (key == "all") { mask = ALL_METRICS; continue; }
+        int found = -1;
+        for (int i = 0; i < NUM_METRICS && found < 0; ++i) {
+            if (key == METRICS[i].key) found = i;
+        }
+        if (found < 0) return false;
+        mask |= 1u << found;
+    }
+    return mask != 0;
+}
+
+// ======================================================
+// PLAYER & GAME OPERATIONS
+// ======================================================
+
+// Make an interactive change durable in the journal, if one is open
+void commitChange(League& league) {
+    if (!league.commit()) console << "Warning: could not write the journal; save to keep this change.\n\n";
+}
+
+// Add a new player and return its index in players vector
+int addPlayer(League& league) {
+    string name = readLine("Enter new player's full name: ");
+    if (name.empty()) {
+        console << "Player name cannot be empty.\n\n";
+        return -1;
+    }
+    // Duplicate names are rejected through the name index
+    int existing = league.find(name);
+    if (existing >= 0) {
+        console << "Player already exists at index " << existing + 1 << ".\n\n";
+        return existing;
+    }
+
+    int idx = league.create(name);
+    commitChange(league);
+    console << "Player '" << name << "' added (index " << idx + 1 << ").\n\n";
+    return idx;
+}
+
+// Select a player by showing a menu, returns index or -1 if none
+int selectPlayer(const League& league) {
+    const vector<Player>& players = league.players;
+    if (players.empty()) {
+        console << "No players available. Add a player first.\n\n";
+        return -1;
+    }
+    console << "\nPlayers:\n\n";
+    for (size_t i = 0; i < players.size(); ++i) {
+        console << (i + 1) << ". " << players[i].name << " (" << gameCount(league, (int)i) << " games)\n\n";
+    }
+    int choice = readInt("Select player number (0 to cancel): ");
+    if (choice == 0) return -1;
+    if (choice < 1 || choice >(int)players.size()) {
+        console << "Invalid selection.\n\n";
+        return -1;
+    }
+    return choice - 1;
+}
+
+// Look a player up by exact name, returns index or -1 if not found
+int findPlayerByName(const League& league) {
+    string name = readLine("Player name: ");
+    if (name.empty()) return -1;
+    int idx = league.find(name);
+    if (idx < 0) console << "No player named '" << name << "'.\n\n";
+    return idx;
+}
+
+// Enter a single game's stats interactively and append to player's games
+void enterGameForPlayer(League& league, int player) {
+    const Player& p = league.players[player];
+    GameStats g;
+    console << "\nEntering new game for " << p.name << ". Use YYYY-MM-DD for date.\n\n";
+    g.date = readDate("Date (YYYY-MM-DD): ");
+    for (int s = 0; s < NUM_STATS; ++s) g.*STAT_DEFS[s].member = readInt(string(STAT_DEFS[s].prompt) + ": ");
+
+    // Basic validation: ensure subcounts don't exceed totals
+    for (const StatRule& r : STAT_PARTS) {
+        if (g.*STAT_DEFS[r.first].member > g.*STAT_DEFS[r.second].member) {
+            console << "Warning: " << STAT_NAMES[r.first] << " > " << STAT_NAMES[r.second] << ". Adjusting "
+                << STAT_NAMES[r.second] << " to be at least " << STAT_NAMES[r.first] << ".\n";
+            g.*STAT_DEFS[r.second].member = g.*STAT_DEFS[r.first].member;
+        }
+    }
+
+    league.addGame(player, g);
+    commitChange(league);
+    console << "Game added for " << p.name << " (" << formatDate(g.date) << ").\n\n";
+}
+
+// Numbered game list in the player's current order (numbers are 1-based list positions)
+void listGames(const Player& p) {
+    console << "\nGames for " << p.name << ":\n\n";
+    for (size_t k = 0; k < p.games.size(); ++k) {
+        size_t i = p.shown(k);
+        console << (k + 1) << ". " << formatDate(p.games.date(i)) << " - " << p.games.stat(i, STAT_POINTS) << " pts\n";
+    }
+}
+
+// Edit an existing game for a player by index (1-based shown to user)
+void editGame(League& league, int player) {
+    const Player& p = league.players[player];
+    if (p.games.empty()) { console << "No games to edit.\n"; return; }
+
+    listGames(p);
+    int idx = readInt("Enter game number to edit (0 to cancel): ");
+    if (idx == 0) return;
+    if (idx < 1 || idx >(int)p.games.size()) { console << "Invalid game number.\n"; return; }
+
+    size_t slot = p.shown(idx - 1);
+    GameStats g = p.games[slot]; // edited copy, written back below
+    console << "Editing Game " << idx << " (" << formatDate(g.date) << "). Press enter to keep current value.\n";
+
+    // Helper lambda: read an int or keep current by empty line
+    auto readIntKeep = [&](const string& prompt, int& field) {
+        console << prompt << " [" << field << "]: ";
+        string line; getline(cin, line);
+        if (line.empty()) return; // keep current
+        stringstream ss(line);
+        int v; if (ss >> v) field = v;
+        else console << "Invalid input; keeping previous value.\n\n";
+        };
+
+    console << "Date (current " << formatDate(g.date) << "): \n";
+    string newDate; getline(cin, newDate);
+    if (!newDate.empty() && !parseDate(newDate, g.date)) {
+        console << "Invalid date; keeping previous value.\n\n";
+    }
+
+    for (int s = 0; s < NUM_STATS; ++s) readIntKeep(STAT_NAMES[s], g.*STAT_DEFS[s].member);
+
+    league.updateGame(player, slot, g);
+    commitChange(league);
+    console << "Game updated.\n\n";
+}
+
+// Delete a game by number (1-based)
+void deleteGame(League& league, int player) {
+    const Player& p = league.players[player];
+    if (p.games.empty()) { console << "No games to delete.\n"; return; }
+
+    listGames(p);
+    int idx = readInt("Enter game number to delete (0 to cancel): ");
+    if (idx == 0) return;
+    if (idx < 1 || idx >(int)p.games.size()) { console << "Invalid game number.\n"; return; }
+
+    string confirm = readLine("Type 'DELETE' to confirm deletion: ");
+    if (confirm == "DELETE") {
+        league.removeGame(player, p.shown(idx - 1));
+        commitChange(league);
+        console << "Game deleted.\n";
+    }
+    else {
+        console << "Deletion cancelled.\n\n";
+    }
+}
+
+// Record the team, opponent and home/away of a game (1-based number)
+void tagGame(League& league, int player) {
+    const Player& p = league.players[player];
+    if (p.games.empty()) { console << "No games to tag.\n"; return; }
+
+    listGames(p);
+    int idx = readInt("Enter game number to tag (0 to cancel): ");
+    if (idx == 0) return;
+    if (idx < 1 || idx >(int)p.games.size()) { console << "Invalid game number.\n"; return; }
+
+    size_t slot = p.shown(idx - 1);
+    GameStats g = p.games[slot];
+    console << "Tagging Game " << idx << " (" << formatDate(g.date) << "). Press enter to keep current value, '-' to clear.\n";
+
+    // Read a team name, keeping the current one on an empty line
+    auto readTeamKeep = [&](const string& prompt, int& field) {
+        console << prompt << " [" << dimLabel(DIM_TEAM, (uint16_t)field) << "]: ";
+        string line; getline(cin, line);
+        string_view name = trimmed(line);
+        if (name.empty()) return;
+        if (name == "-") field = 0;
+        else if (name.find('|') != string_view::npos) console << "Team names cannot contain '|'; keeping previous value.\n\n";
+        else {
+            uint16_t id;
+            if (teamDict.idOf(name, id)) field = id;
+            else console << "Cannot add team: " << TeamDictionary::FULL_ERROR << "; keeping previous value.\n\n";
+        }
+        };
+
+    readTeamKeep("Team", g.team);
+    readTeamKeep("Opponent", g.opponent);
+    console << "Home or away [" << dimLabel(DIM_VENUE, (uint16_t)g.venue) << "]: ";
+    string line; getline(cin, line);
+    string_view venue = trimmed(line);
+    uint16_t v;
+    if (venue == "-") g.venue = VENUE_NONE;
+    else if (!venue.empty() && parseVenue(venue, v)) g.venue = v;
+    else if (!venue.empty()) console << "Enter home or away; keeping previous value.\n\n";
+
+    league.updateGame(player, slot, g);
+    commitChange(league);
+    console << "Game tagged.\n\n";
+}
+
+// ======================================================
+// SORTING FUNCTIONS
+// ======================================================
+
+// The sort functions change the order games are listed in (menus, charts,
+// CSV export) without moving them in storage; views are cached in GameStore.
+
+// List games by date (ascending)
+void sortGamesByDate(Player& p) {
+    BSTATS_PROBE(PROBE_SORT);
+    p.view = GameStore::VIEW_BY_DATE;
+    console << "Games sorted by date (oldest -> newest).\n\n";
+}
+
+// List games by points (descending)
+void sortGamesByPoints(Player& p) {
+    BSTATS_PROBE(PROBE_SORT);
+    p.view = STAT_POINTS;
+    console << "Games sorted by points (highest -> lowest).\n\n";
+}
+
+// Pick any listing order: entry order, date, or highest-first by a stat
+void chooseGameOrder(Player& p) {
+    BSTATS_PROBE(PROBE_SORT);
+    console << "0. Entry order\n";
+    for (int s = 0; s < NUM_STATS; ++s) console << (s + 1) << ". " << STAT_NAMES[s] << " (highest first)\n";
+    console << (NUM_STATS + 1) << ". Date (oldest first)\n";
+    int c = readInt("Order: ");
+    if (c < 0 || c > NUM_STATS + 1) { console << "Invalid choice.\n"; return; }
+    p.view = c == 0 ? Player::VIEW_STORAGE : c - 1;
+    console << "Game list order changed.\n\n";
+}
+
+// ======================================================
+// STATS REPORTS: totals, averages, best game, ASCII chart
+// ======================================================
+
+// Show totals and shooting percentages
+void showTotals(const Player& p, ostream& out = console) {
+    BSTATS_PROBE(PROBE_SHOW_TOTALS);
+    if (p.games.empty()) { out << "No games to report.\n\n"; return; }
+
+    const long long* t = p.games.totals().sum;
+    out << fixed << setprecision(2);
+    out << "\n=== TOTALS for " << p.name << " ===\n\n";
+    out << "Games: " << p.games.size() << "\n\n";
+    for (int s = 0; s < NUM_STATS; ++s) {
+        if (*STAT_DEFS[s].perGame) out << STAT_NAMES[s] << ": " << t[s] << "\n\n";
+    }
+    for (const ShotDef& d : SHOT_DEFS) {
+        out << d.name << ": " << pct(t[d.made], t[d.attempted]) << "% (" << t[d.made] << "/" << t[d.attempted] << ")\n\n";
+    }
+}
+
+// Show per-game averages
+void showAverages(const Player& p, ostream& out = console) {
+    BSTATS_PROBE(PROBE_SHOW_AVERAGES);
+    if (p.games.empty()) { out << "No games to report.\n"; return; }
+
+    const long long* t = p.games.totals().sum;
+    double n = (double)p.games.size();
+    out << fixed << setprecision(2);
+    out << "\n=== AVERAGES for " << p.name << " ===\n\n";
+    for (int s = 0; s < NUM_STATS; ++s) {
+        if (*STAT_DEFS[s].perGame) out << STAT_DEFS[s].perGame << ": " << t[s] / n << "\n\n";
+    }
+    out << "Simple PER: " << simplePER(p) << "\n\n";
+}
+
+// Show the advanced metrics in mask, in table order
+void showAdvancedMetrics(const Player& p, MetricMask mask = ALL_METRICS, ostream& out = console) {
+    BSTATS_PROBE(PROBE_SHOW_ADVANCED);
+    if (p.games.empty()) { out << "No games to report.\n"; return; }
+
+    MetricInputs m = gatherMetrics(p.games, mask);
+    out << "\n=== ADVANCED METRICS for " << p.name << " ===\n\n";
+    for (int i = 0; i < NUM_METRICS; ++i) {
+        if (!(mask >> i & 1)) continue;
+        const MetricDef& d = METRICS[i];
+        out << d.label << ": " << fixed << setprecision(d.decimals) << d.value(m) << "\n\n";
+    }
+}
+
+// Find and show the best scoring game(s)
+void showBestScoringGames(const Player& p, ostream& out = console) {
+    BSTATS_PROBE(PROBE_SHOW_BEST);
+    if (p.games.empty()) { out << "No games to report.\n"; return; }
+    // One pass in list order: keep the list positions tied for the best so far
+    const int32_t* pts = p.games.column(STAT_POINTS);
+    int bestPts = INT32_MIN;
+    vector<size_t> best;
+    for (size_t k = 0; k < p.games.size(); ++k) {
+        int v = pts[p.shown(k)];
+        if (v < bestPts) continue;
+        if (v > bestPts) { bestPts = v; best.clear(); }
+        best.push_back(k);
+    }
+
+    out << "\n=== Best Scoring Game(s): " << bestPts << " pts ===\n";
+    for (size_t k : best) {
+        GameStats g = p.games[p.shown(k)];
+        out << (k + 1) << ". " << formatDate(g.date) << " - " << g.points << " pts, "
+            << "FG%=" << fixed << setprecision(1) << pct(g.fgm, g.fga) << "%, "
+            << "3P=" << pct(g.threem, g.threea) << "%\n";
+    }
+}
+
+// How a chart turns games into bars. Calendar buckets follow date order;
+// the others follow the player's current list order.
+enum ChartBucket { CHART_GAME, CHART_WEEK, CHART_MONTH, CHART_SEASON, CHART_ROLLING, CHART_FIT, NUM_CHART_BUCKETS };
+const char* const CHART_BUCKET_NAMES[NUM_CHART_BUCKETS] = { "game", "week", "month", "season", "rolling", "fit" };
+
+struct ChartOptions {
+    StatId stat = STAT_POINTS;
+    ChartBucket bucket = CHART_GAME;
+    size_t window = 5;  // games per CHART_ROLLING average
+    int width = 0;      // columns to fit the chart in; 0 = the terminal's
+};
+
+// Columns of the terminal: $COLUMNS, then the size of the tty on stdout, else 80
+int terminalWidth() {
+    if (const char* env = getenv("COLUMNS")) {
+        char* end;
+        long w = strtol(env, &end, 10);
+        if (end != env && *end == '\0' && w > 0 && w < 10000) return (int)w;
+    }
+#ifndef _WIN32
+    winsize ws;
+    if (ioctl(STDOUT_FILENO, TIOCGWINSZ, &ws) == 0 && ws.ws_col > 0) return ws.ws_col;
+#endif
+    return 80;
+}
+
+// One bar: the date it starts at, the games it covers and the value it shows
+struct ChartBar {
+    int32_t day;    // first game's date, or the Monday starting a week bucket
+    size_t games;
+    double value;
+};
+
+// Write b's label at out: a date, "YYYY-MM" for months or "YYYY-YY" for
+// seasons; returns the end
+char* chartLabelTo(char* out, const ChartBar& b, ChartBucket bucket) {
+    if (bucket == CHART_SEASON) {
+        string season = formatSeason(seasonOf(b.day));
+        return copy(season.begin(), season.end(), out);
+    }
+    char* end = formatDateTo(out, b.day);
+    return bucket == CHART_MONTH ? out + 7 : end;
+}
+
+// Append v right-aligned in width characters
+void appendPadded(string& out, long long v, size_t width) {
+    char buf[24];
+    char* end = to_chars(buf, buf + sizeof(buf), v).ptr;
+    if ((size_t)(end - buf) < width) out.append(width - (end - buf), ' ');
+    out.append(buf, end);
+}
+
+// Bars of p's games under opt, every value from prefix sums of the stat
+vector<ChartBar> chartBars(const Player& p, const ChartOptions& opt, size_t columns) {
+    vector<ChartBar> bars;
+    size_t n = p.games.size();
+    if (opt.bucket == CHART_WEEK || opt.bucket == CHART_MONTH || opt.bucket == CHART_SEASON) {
+        // A bucket is a run of date-ordered games with the same week (from
+        // Monday), month or season
+        const vector<int32_t>& dates = p.byDate.dates(p.games);
+        const vector<long long>& pre = p.byDate.prefixSums(p.games, opt.stat);
+        auto bucketOf = [&](int32_t day) -> int64_t {
+            if (opt.bucket == CHART_SEASON) return seasonOf(day);
+            if (opt.bucket == CHART_WEEK) return ((int64_t)day + 3 - (day < -3 ? 6 : 0)) / 7; // 1970-01-01 was a Thursday
+            int y; unsigned m, d;
+            civilFromDays(day, y, m, d);
+            return (int64_t)y * 12 + m - 1;
+            };
+        for (size_t b = 0; b < n;) {
+            int64_t key = bucketOf(dates[b]);
+            size_t e = b + 1;
+            while (e < n && bucketOf(dates[e]) == key) ++e;
+            int32_t day = opt.bucket == CHART_WEEK ? (int32_t)(key * 7 - 3) : dates[b];
+            bars.push_back({ day, e - b, (double)(pre[e] - pre[b]) / (e - b) });
+            b = e;
+        }
+        return bars;
+    }
+    vector<long long> pre(n + 1, 0);
+    const int32_t* col = p.games.column(opt.stat);
+    for (size_t k = 0; k < n; ++k) pre[k + 1] = pre[k] + col[p.shown(k)];
+    // CHART_FIT: equal runs of games, few enough for one column each
+    size_t step = opt.bucket == CHART_FIT ? (n + columns - 1) / max<size_t>(1, columns) : 1;
+    for (size_t b = 0; b < n; b += step) {
+        size_t e = min(n, b + step);
+        size_t from = opt.bucket == CHART_ROLLING ? (e > opt.window ? e - opt.window : 0) : b;
+        bars.push_back({ p.games.date(p.shown(b)), e - from, (double)(pre[e] - pre[from]) / (e - from) });
+    }
+    return bars;
+}
+
+// Bar chart of any stat, one bar per game, week, month or season, per
+// rolling average or squeezed into the terminal width. The whole chart is
+// built in one buffer and written at once.
+void showAsciiChart(const Player& p, const ChartOptions& opt = ChartOptions(), ostream& out = console) {
+    BSTATS_PROBE(PROBE_SHOW_CHART);
+    if (p.games.empty()) { out << "No games to chart.\n"; return; }
+    int width = max(opt.width > 0 ? opt.width : terminalWidth(), 40);
+    const char* const PER[NUM_CHART_BUCKETS] = { "Game", "Week", "Month", "Season", "Game", "Game" };
+    string unit = statKey(opt.stat);
+    string frame;
+    char buf[96], label[DATE_CHARS];
+
+    if (opt.bucket == CHART_FIT) {
+        // Columns left to right, CHART_ROWS high, after a 9-character axis
+        const int CHART_ROWS = 12, AXIS = 9;
+        vector<ChartBar> bars = chartBars(p, opt, (size_t)(width - AXIS));
+        double top = 0;
+        for (const ChartBar& b : bars) top = max(top, b.value);
+        snprintf(buf, sizeof(buf), "\n=== ASCII Chart: %s per Game, %zu game(s) per column ===\n\n",
+            STAT_NAMES[opt.stat], bars[0].games);
+        frame += buf;
+        for (int r = CHART_ROWS; r >= 1; --r) {
+            if (r == CHART_ROWS || r == 1 || r == CHART_ROWS / 2) snprintf(buf, sizeof(buf), "%7.1f |", top * r / CHART_ROWS);
+            else snprintf(buf, sizeof(buf), "%7s |", "");
+            frame += buf;
+            for (const ChartBar& b : bars) frame += top > 0 && lround(b.value / top * CHART_ROWS) >= r ? '*' : ' ';
+            frame += '\n';
+        }
+        frame += string(AXIS - 1, ' ') + '+' + string(bars.size(), '-') + '\n';
+        frame.append(AXIS, ' ').append(label, chartLabelTo(label, bars.front(), CHART_GAME));
+        if (bars.size() > DATE_CHARS * 2) {
+            frame.append(bars.size() - 2 * DATE_CHARS, ' ').append(label, chartLabelTo(label, bars.back(), CHART_GAME));
+        }
+        frame += '\n';
+    }
+    else {
+        vector<ChartBar> bars = chartBars(p, opt, 0);
+        double top = 0;
+        for (const ChartBar& b : bars) top = max(top, b.value);
+        // Games are numbered in list order; "*" is 2 points (1 of another
+        // stat), more when the longest bar would not fit
+        const size_t PREFIX[NUM_CHART_BUCKETS] = { 23, 29, 26, 26, 26, 0 }; // characters before the bar
+        size_t prefix = PREFIX[opt.bucket];
+        long long scale = opt.stat == STAT_POINTS ? 2 : 1;
+        size_t room = width > (int)prefix ? width - prefix : 1;
+        if (top / scale > room) scale = (long long)ceil(top / room);
+        if (opt.bucket == CHART_ROLLING) {
+            snprintf(buf, sizeof(buf), "\n=== ASCII Chart: %s, %zu-Game Rolling Average (each '*' = %lld %s) ===\n\n",
+                STAT_NAMES[opt.stat], opt.window, scale, unit.c_str());
+        }
+        else {
+            snprintf(buf, sizeof(buf), "\n=== ASCII Chart: %s per %s (each '*' = %lld %s) ===\n\n",
+                STAT_NAMES[opt.stat], PER[opt.bucket], scale, unit.c_str());
+        }
+        frame += buf;
+        frame.reserve(frame.size() + bars.size() * (prefix + room + 1));
+        for (size_t k = 0; k < bars.size(); ++k) {
+            const ChartBar& b = bars[k];
+            if (opt.bucket == CHART_GAME || opt.bucket == CHART_ROLLING) {
+                appendPadded(frame, (long long)k + 1, 3);
+                frame += ' ';
+            }
+            frame.append(1, '[').append(label, chartLabelTo(label, b, opt.bucket)).append("] ");
+            if (opt.bucket == CHART_GAME) {
+                appendPadded(frame, (long long)b.value, 3);
+            }
+            else {
+                if (opt.bucket != CHART_ROLLING) {
+                    appendPadded(frame, (long long)b.games, 4);
+                    frame += " g ";
+                }
+                snprintf(buf, sizeof(buf), "%6.1f", b.value);
+                frame += buf;
+            }
+            frame.append(" | ").append((size_t)max(0L, lround(b.value / scale)), '*');
+            frame += '\n';
+        }
+    }
+    out.write(frame.data(), frame.size());
+}
+
+// Ask for the stat and the kind of chart, then draw it
+void chartMenu(const Player& p) {
+    if (p.games.empty()) { console << "No games to chart.\n"; return; }
+    ChartOptions opt;
+    for (int s = 0; s < NUM_STATS; ++s) console << (s + 1) << ". " << STAT_NAMES[s] << '\n';
+    int s = readInt("Stat to chart: ");
+    if (s < 1 || s > NUM_STATS) { console << "Invalid choice.\n"; return; }
+    opt.stat = (StatId)(s - 1);
+    console << "1. Every game\n2. Per week\n3. Per month\n4. Per season\n5. Rolling average\n6. Whole career, fit to the terminal width\n";
+    int c = readInt("Chart type: ");
+    if (c < 1 || c > NUM_CHART_BUCKETS) { console << "Invalid choice.\n"; return; }
+    opt.bucket = (ChartBucket)(c - 1);
+    if (opt.bucket == CHART_ROLLING) {
+        int w = readInt("Games per average: ");
+        if (w < 1) { console << "Number must be positive.\n\n"; return; }
+        opt.window = (size_t)w;
+    }
+    showAsciiChart(p, opt);
+}
+
+// Totals, per-game averages, shooting percentages and simple PER over a
+// slice of games returned by the player's DateQueryIndex
+void showQueryResult(const Player& p, const string& label, const QueryResult& r, ostream& out = console) {
+    BSTATS_PROBE(PROBE_SHOW_QUERY);
+    out << "\n=== " << label << " for " << p.name << " ===\n\n";
+    if (r.games == 0) { out << "No games in range.\n\n"; return; }
+    const long long* t = r.totals.sum;
+    double n = (double)r.games;
+    out << fixed << setprecision(2);
+    out << "Games: " << r.games << " (" << formatDate(r.firstDate) << " to " << formatDate(r.lastDate) << ")\n\n";
+    for (int s = 0; s < NUM_STATS; ++s) {
+        if (*STAT_DEFS[s].perGame) out << STAT_NAMES[s] << ": " << t[s] << " (" << STAT_DEFS[s].perGame << ' ' << t[s] / n << ")\n\n";
+    }
+    for (const ShotDef& d : SHOT_DEFS) {
+        out << d.name << ": " << pct(t[d.made], t[d.attempted]) << "% (" << t[d.made] << "/" << t[d.attempted] << ")\n\n";
+    }
+    out << "Simple PER: " << r.totals.perRaw / n << "\n\n";
+}
+
+// Ask for a date range or a last-N window and report on it
+void queryGamesMenu(Player& p) {
+    if (p.games.empty()) { console << "No games to query.\n\n"; return; }
+    console << "1. Games between two dates\n";
+    console << "2. Last N games\n";
+    int kind = readInt("Query type: ");
+    if (kind == 1) {
+        int32_t from = readDate("From (YYYY-MM-DD): ");
+        int32_t to = readDate("To (YYYY-MM-DD): ");
+        showQueryResult(p, formatDate(from) + " to " + formatDate(to), p.byDate.dateRange(p.games, from, to));
+    }
+    else if (kind == 2) {
+        int n = readInt("Number of games: ");
+        if (n < 1) { console << "Number of games must be positive.\n\n"; return; }
+        showQueryResult(p, "Last " + to_string(n) + " games", p.byDate.lastGames(p.games, (size_t)n));
+    }
+    else {
+        console << "Invalid choice.\n";
+    }
+}
+
+// ======================================================
+// LEADERBOARD REPORTS: top players and games across the league
+// ======================================================
+
+// Top k players under r. Each player is one O(1) read of the running
+// totals; only the few that beat the current k-th place touch the heap.
+vector<Ranked> topPlayers(const vector<Player>& players, const Ranking& r, size_t k) {
+    BSTATS_PROBE(PROBE_LEADERBOARD);
+    TopK top(k);
+    for (size_t i = 0; i < players.size(); ++i) {
+        const GameStore& g = players[i].games;
+        if (g.empty()) continue;
+        double v = rankValue(r, g.totals(), g.size());
+        if (top.admits(v)) top.offer({ v, (int)i, 0 });
+    }
+    return top.take();
+}
+
+// Offer every game of players[i] to top
+void offerGames(TopK& top, const vector<Player>& players, size_t i, const Ranking& r) {
+    const GameStore& g = players[i].games;
+    if (r.kind != Ranking::PER) {
+        const int32_t* col = g.column(r.stat);
+        for (size_t j = 0; j < g.size(); ++j) {
+            if (top.admits(col[j])) top.offer({ (double)col[j], (int)i, (uint32_t)j });
+        }
+        return;
+    }
+    int32_t v[NUM_STATS];
+    for (size_t j = 0; j < g.size(); ++j) {
+        g.values(j, v);
+        double x = (double)perRawOf(v);
+        if (top.admits(x)) top.offer({ x, (int)i, (uint32_t)j });
+    }
+}
+
+// Top k single games under r, from one pass over every player's games
+vector<Ranked> topGames(const vector<Player>& players, const Ranking& r, size_t k) {
+    BSTATS_PROBE(PROBE_LEADERBOARD);
+    TopK top(k);
+    for (size_t i = 0; i < players.size(); ++i) offerGames(top, players, i, r);
+    return top.take();
+}
+
+string rankingLabel(const Ranking& r) {
+    if (r.kind == Ranking::PER) return "Simple PER";
+    string name = STAT_NAMES[r.stat];
+    return r.kind == Ranking::PER_GAME ? name + " per game" : name;
+}
+
+// Parse a metric name: a stat (points, rebounds, ..., 3pm, fta), a per-game
+// average (ppg, rpg, apg, spg, bpg) or per
+bool parseRanking(string_view key, Ranking& r) {
+    auto same = [](string_view a, const char* b) {
+        size_t n = strlen(b);
+        if (a.size() != n) return false;
+        for (size_t i = 0; i < n; ++i) {
+            if (tolower((unsigned char)a[i]) != tolower((unsigned char)b[i])) return false;
+        }
+        return true;
+        };
+    if (same(key, "per")) { r.kind = Ranking::PER; return true; }
+    for (int s = 0; s < NUM_STATS; ++s) {
+        if (same(key, STAT_NAMES[s])) { r.kind = Ranking::TOTAL; r.stat = (StatId)s; return true; }
+    }
+    for (int s = 0; s < NUM_STATS; ++s) {
+        if (*STAT_DEFS[s].perGame && same(key, STAT_DEFS[s].perGame)) { r.kind = Ranking::PER_GAME; r.stat = (StatId)s; return true; }
+    }
+    return false;
+}
+
+void showPlayerBoard(const vector<Player>& players, const string& title, const Ranking& r,
+    const vector<Ranked>& board, ostream& out = console) {
+    out << "\n=== " << title << " ===\n\n";
+    if (board.empty()) { out << "No games to rank.\n"; return; }
+    int decimals = r.kind == Ranking::TOTAL ? 0 : 2;
+    for (size_t i = 0; i < board.size(); ++i) {
+        out << setw(3) << (i + 1) << ". " << players[board[i].player].name << " - "
+            << fixed << setprecision(decimals) << board[i].value << '\n';
+    }
+}
+
+void showGameBoard(const vector<Player>& players, const string& title, const vector<Ranked>& board,
+    ostream& out = console) {
+    out << "\n=== " << title << " ===\n\n";
+    if (board.empty()) { out << "No games to rank.\n"; return; }
+    for (size_t i = 0; i < board.size(); ++i) {
+        const Player& p = players[board[i].player];
+        out << setw(3) << (i + 1) << ". " << p.name << " (" << formatDate(p.games.date(board[i].slot)) << ") - "
+            << (long long)board[i].value << '\n';
+    }
+}
+
+// Leaderboard title, e.g. "Top 10 Players: Points per game"
+string boardTitle(const string& prefix, size_t k, bool games, const Ranking& r) {
+    return prefix + to_string(k) + (games ? " Games: " : " Players: ") + rankingLabel(r);
+}
+
+// League-wide leaderboard, reused until the league changes. A game board
+// keeps each player's own top k games, so after a change only the players
+// whose version moved are scanned again before the lists are merged (ties
+// are ordered by player and game, so the merge equals a full scan). Player
+// boards read one running total per player and are simply rebuilt.
+const vector<Ranked>& cachedBoard(League& league, const Ranking& r, size_t k, bool games) {
+    string key = (games ? "games/" : "players/") + to_string(r.kind) + "/" + to_string(r.stat) + "/" + to_string(k);
+    CachedReport<vector<Ranked>>& c = league.cache.boards[key];
+    if (c.version == league.version) return c.result;
+    if (!games) {
+        c.result = topPlayers(league.players, r, k);
+    }
+    else {
+        BSTATS_PROBE(PROBE_LEADERBOARD);
+        for (size_t i : c.stale(league.players)) {
+            TopK own(k);
+            offerGames(own, league.players, i, r);
+            c.parts[i] = own.take();
+        }
+        TopK top(k);
+        for (const auto& part : c.parts) {
+            for (const Ranked& e : part) {
+                if (!top.admits(e.value)) break; // parts are best first
+                top.offer(e);
+            }
+        }
+        c.result = top.take();
+    }
+    c.version = league.version;
+    return c.result;
+}
+
+// Interactive leaderboards over the whole league or this session's games
+void leaderboardMenu(League& league) {
+    console << "1. Top players by total\n";
+    console << "2. Top players by per-game average\n";
+    console << "3. Top players by simple PER\n";
+    console << "4. Top single games\n";
+    console << "5. Tonight: top players (games added this session)\n";
+    console << "6. Tonight: top single games\n";
+    int c = readInt("Leaderboard: ");
+    if (c < 1 || c > 6) { console << "Invalid choice.\n"; return; }
+
+    bool games = c == 4 || c == 6;
+    Ranking r;
+    if (c == 3) {
+        r.kind = Ranking::PER;
+    }
+    else {
+        for (int s = 0; s < NUM_STATS; ++s) console << (s + 1) << ". " << STAT_NAMES[s] << '\n';
+        if (games) console << (NUM_STATS + 1) << ". Simple PER\n";
+        int s = readInt("Rank by: ");
+        if (s < 1 || s > NUM_STATS + (games ? 1 : 0)) { console << "Invalid choice.\n"; return; }
+        if (s == NUM_STATS + 1) r.kind = Ranking::PER;
+        else {
+            r.kind = c == 2 ? Ranking::PER_GAME : Ranking::TOTAL;
+            r.stat = (StatId)(s - 1);
+        }
+    }
+    int k = readInt("How many (e.g. 10): ");
+    if (k < 1) { console << "Number must be positive.\n\n"; return; }
+
+    const vector<Player>& players = league.players;
+    if (c >= 5 && league.session.games() == 0) { console << "No games added this session.\n\n"; return; }
+    if (c == 5) showPlayerBoard(players, boardTitle("Tonight's Top ", k, false, r), r, league.session.topPlayers(r, k));
+    else if (c == 6) showGameBoard(players, boardTitle("Tonight's Top ", k, true, r), league.session.topGames(r, k));
+    else if (games) showGameBoard(players, boardTitle("Top ", k, true, r), cachedBoard(league, r, k, true));
+    else showPlayerBoard(players, boardTitle("Top ", k, false, r), r, cachedBoard(league, r, k, false));
+}
+
+// ======================================================
+// FILE I/O: Save/Load all players, Export CSV for a player
+// ======================================================
+
+// Saves go to "<file>.tmp", which is forced to disk and then renamed over
+// the file, so a crash mid-save leaves the previous version intact
+string tempFileFor(const string& filename) { return filename + ".tmp"; }
+
+bool commitTempFile(const string& filename) {
+    string tmp = tempFileFor(filename);
+#ifndef _WIN32
+    int fd = ::open(tmp.c_str(), O_RDONLY);
+    bool synced = fd >= 0 && fsync(fd) == 0;
+    if (fd >= 0) ::close(fd);
+    if (!synced) return false;
+#endif
+    error_code ec;
+    filesystem::rename(tmp, filename, ec);
+    if (ec) return false;
+#ifndef _WIN32
+    // Make the rename itself durable
+    string dir = filesystem::path(filename).parent_path().string();
+    fd = ::open(dir.empty() ? "." : dir.c_str(), O_RDONLY);
+    if (fd >= 0) { fsync(fd); ::close(fd); }
+#endif
+    return true;
+}
+
+// Save all players and their games to a text file in a simple format.
+// Format:
+// <numPlayers>
+// For each player:
+//   <name>
+//   <numGames>
+//   For each game: date points rebounds assists steals blocks fgm fga threem threea ftm fta
+//   followed by " | team | opponent | home/away" if any of those is recorded
+bool saveAllPlayersToFile(const vector<Player>& players, const string& filename = "players_data.txt", ostream& log = console) {
+    BSTATS_PROBE(PROBE_SAVE_TEXT);
+    ofstream out(tempFileFor(filename));
+    if (!out) {
+        log << "Error opening '" << filename << "' for writing.\n\n";
+        return false;
+    }
+    out << players.size() << '\n';
+    for (const auto& p : players) {
+        // Escape newline issues by writing name on a single line (no internal newlines allowed)
+        out << p.name << '\n';
+        out << p.games.size() << '\n';
+        for (const GameStats& g : p.games) {
+            // Write each field separated by spaces; date as YYYY-MM-DD
+            out << formatDate(g.date);
+            for (int s = 0; s < NUM_STATS; ++s) out << ' ' << g.*STAT_DEFS[s].member;
+            // Dimensions only when recorded, so older files keep their layout
+            if (g.team || g.opponent || g.venue) {
+                out << " | " << teamDict.name((uint16_t)g.team) << " | " << teamDict.name((uint16_t)g.opponent)
+                    << " | " << VENUE_NAMES[g.venue];
+            }
+            out << '\n';
+        }
+    }
+    BSTATS_BYTES(PROBE_SAVE_TEXT, 0, (uint64_t)out.tellp());
+    out.close();
+    if (!out || !commitTempFile(filename)) {
+        log << "Error writing '" << filename << "'.\n\n";
+        remove(tempFileFor(filename).c_str());
+        return false;
+    }
+    status(log) << "Saved all players to '" << filename << "'.\n\n";
+    return true;
+}
+
+// Cursor over an in-memory text buffer; tracks the line number for error messages
+struct TextCursor {
+    const char* pos;
+    const char* end;
+    size_t line = 0;
+
+    TextCursor(const char* b, const char* e) : pos(b), end(e) {}
+
+    // Next line without its terminator ("\n" or "\r\n"); false at end of buffer
+    bool nextLine(string_view& out) {
+        if (pos == end) return false;
+        const char* nl = (const char*)memchr(pos, '\n', end - pos);
+        const char* stop = nl ? nl : end;
+        out = string_view(pos, stop - pos);
+        if (!out.empty() && out.back() == '\r') out.remove_suffix(1);
+        pos = nl ? nl + 1 : end;
+        ++line;
+        return true;
+    }
+};
+
+// Split the next space-separated token off the front of rest
+bool nextToken(string_view& rest, string_view& token) {
+    size_t b = rest.find_first_not_of(" \t");
+    if (b == string_view::npos) { rest = string_view(); return false; }
+    size_t e = rest.find_first_of(" \t", b);
+    if (e == string_view::npos) e = rest.size();
+    token = rest.substr(b, e - b);
+    rest.remove_prefix(e);
+    return true;
+}
+
+// Parse a whole token as an integer of type T
+template <typename T>
+bool parseNumber(string_view token, T& value) {
+    auto r = from_chars(token.data(), token.data() + token.size(), value);
+    return r.ec == errc() && r.ptr == token.data() + token.size();
+}
+
+// Parse the " | team | opponent | venue" tail of a game record into NUM_DIMS ids
+bool parseDimTail(string_view tail, uint16_t* dims, string& error) {
+    string_view field[NUM_DIMS];
+    for (int k = 0; k < NUM_DIMS; ++k) {
+        size_t bar = k + 1 < NUM_DIMS ? tail.find('|') : string_view::npos;
+        if (k + 1 < NUM_DIMS && bar == string_view::npos) {
+            error = "expected 'team | opponent | venue' after '|'";
+            return false;
+        }
+        field[k] = trimmed(tail.substr(0, bar));
+        tail = bar == string_view::npos ? string_view() : tail.substr(bar + 1);
+    }
+    if (field[DIM_VENUE].find('|') != string_view::npos) { error = "too many '|' fields"; return false; }
+    if (!parseVenue(field[DIM_VENUE], dims[DIM_VENUE])) {
+        error = "invalid venue '" + string(field[DIM_VENUE]) + "' (expected home, away or nothing)";
+        return false;
+    }
+    if (!teamDict.idOf(field[DIM_TEAM], dims[DIM_TEAM]) || !teamDict.idOf(field[DIM_OPPONENT], dims[DIM_OPPONENT])) {
+        error = TeamDictionary::FULL_ERROR;
+        return false;
+    }
+    return true;
+}
+
+// Parse one "date points ... fta [| team | opponent | venue]" record into
+// the stats and NUM_DIMS dimension ids (0 when the tail is absent). On
+// failure returns false and describes the problem in error.
+bool parseGameLine(string_view line, int32_t& date, int32_t* stats, uint16_t* dims, string& error) {
+    size_t bar = line.find('|');
+    for (int k = 0; k < NUM_DIMS; ++k) dims[k] = 0;
+    if (bar != string_view::npos) {
+        if (!parseDimTail(line.substr(bar + 1), dims, error)) return false;
+        line = line.substr(0, bar);
+    }
+    string_view token;
+    if (!nextToken(line, token)) { error = "expected a game record"; return false; }
+    if (!parseDate(token, date)) { error = "invalid date '" + string(token) + "' (expected YYYY-MM-DD)"; return false; }
+    for (int s = 0; s < NUM_STATS; ++s) {
+        if (!nextToken(line, token)) {
+            error = string("missing ") + STAT_DEFS[s].field + " (expected " + to_string(NUM_STATS + 1) + " fields)";
+            return false;
+        }
+        if (!parseNumber(token, stats[s])) {
+            error = string("invalid ") + STAT_DEFS[s].field + " '" + string(token) + "'";
+            return false;
+        }
+    }
+    if (nextToken(line, token)) { error = "unexpected extra field '" + string(token) + "'"; return false; }
+    return true;
+}
+
+// Read a whole file into memory; false if it cannot be opened
+bool readWholeFile(const string& filename, string& data) {
+    ifstream in(filename, ios::binary | ios::ate);
+    if (!in) return false;
+    data.resize((size_t)in.tellg());
+    in.seekg(0);
+    in.read(&data[0], data.size());
+    return (bool)in;
+}
+
+// Move freshly parsed players into the league (replacing it unless merge is
+// set) and return the "Loaded N"/"Merged N (M new)" message prefix. Column
+// slack left by merging players with the same name is released, so a loaded
+// league holds only the bytes its games need.
+string mergeLoaded(League& league, vector<Player>& loaded, bool merge) {
+    if (!merge) league.clear();
+    size_t before = league.players.size();
+    league.players.reserve(before + loaded.size());
+    for (auto& p : loaded) league.merge(move(p));
+    for (Player& p : league.players) p.games.shrinkToFit();
+    if (!merge) return "Loaded " + to_string(league.players.size());
+    return "Merged " + to_string(loaded.size()) + " (" + to_string(league.players.size() - before) + " new)";
+}
+
+// Load players from file created by saveAllPlayersToFile.
+// The file is read in one go and parsed in a single pass without touching
+// stdin. Vectors are reserved from the counts stored in the file. A malformed
+// line aborts the load with its line number and leaves players unchanged.
+// Players whose name is already present are merged (their games appended);
+// with merge set the file is added to the current league instead of
+// replacing it.
+bool loadAllPlayersFromFile(League& league, const string& filename = "players_data.txt", ostream& log = console,
+    bool merge = false) {
+    BSTATS_PROBE(PROBE_LOAD_TEXT);
+    string data;
+    if (!readWholeFile(filename, data)) {
+        log << "No saved file '" << filename << "' found.\n\n";
+        return false;
+    }
+    BSTATS_BYTES(PROBE_LOAD_TEXT, data.size(), 0);
+    TextCursor cur(data.data(), data.data() + data.size());
+    string_view line, token;
+    string error;
+
+    auto fail = [&](const string& what) {
+        log << "Error: " << filename << " line " << cur.line << ": " << what << ".\n\n";
+        return false;
+        };
+    // Read a line holding a single count
+    auto readCount = [&](size_t& n, const char* what) {
+        if (!cur.nextLine(line)) { ++cur.line; error = string("expected ") + what + ", found end of file"; return false; }
+        string_view rest = line;
+        if (!nextToken(rest, token) || !parseNumber(token, n) || nextToken(rest, token)) {
+            error = string("expected ") + what + ", found '" + string(line) + "'";
+            return false;
+        }
+        return true;
+        };
+
+    size_t numPlayers = 0;
+    if (!readCount(numPlayers, "player count")) return fail(error);
+
+    // Counts come from the file, so reserve no more than the bytes left could
+    // hold: a player takes at least two lines, a game record a date and
+    // NUM_STATS one-digit fields. A wrong count then fails at end of file.
+    const size_t MIN_PLAYER_BYTES = 3, MIN_GAME_BYTES = DATE_CHARS + 2 * NUM_STATS;
+    auto bytesLeft = [&]() { return (size_t)(cur.end - cur.pos); };
+    vector<Player> loaded;
+    loaded.reserve(min(numPlayers, bytesLeft() / MIN_PLAYER_BYTES));
+    int32_t date;
+    int32_t stats[NUM_STATS];
+    uint16_t dims[NUM_DIMS];
+    for (size_t i = 0; i < numPlayers; ++i) {
+        if (!cur.nextLine(line)) { ++cur.line; return fail("expected player name, found end of file"); }
+        loaded.emplace_back(line);
+        Player& p = loaded.back();
+
+        size_t numGames = 0;
+        if (!readCount(numGames, "game count")) return fail(error);
+        p.games.reserve(min(numGames, bytesLeft() / MIN_GAME_BYTES));
+        for (size_t j = 0; j < numGames; ++j) {
+            if (!cur.nextLine(line)) { ++cur.line; return fail("expected game record, found end of file"); }
+            if (!parseGameLine(line, date, stats, dims, error)) return fail(error);
+            p.games.appendUntracked(date, stats, dims);
+        }
+        p.games.retotal();
+    }
+    // Only blank lines may follow the last player
+    while (cur.nextLine(line)) {
+        if (line.find_first_not_of(" \t") != string_view::npos) return fail("unexpected data after last player");
+    }
+
+    status(log) << mergeLoaded(league, loaded, merge) << " players from file.\n\n";
+    return true;
+}
+
+// Column names in the order formatCsvRow writes them, spelled out from the schema
+#define BSTATS_CSV_STAT(id, field, name, prompt, perGame, pointValue) name ","
+#define BSTATS_CSV_SHOT(name, key, made, attempted) name ","
+const char CSV_HEADER[] = "Date," BSTATS_STATS(BSTATS_CSV_STAT) BSTATS_SHOTS(BSTATS_CSV_SHOT)
+    "Team,Opponent,Venue\n";
+#undef BSTATS_CSV_STAT
+#undef BSTATS_CSV_SHOT
+
+// Upper bound on one CSV row: date, NUM_STATS int32 values, NUM_SHOTS
+// percentages, the venue and the separators. Team names come on top
+// (see csvDimBytes).
+const size_t CSV_ROW_MAX = DATE_CHARS + NUM_STATS * 12 + NUM_SHOTS * 24 + 4 + 7;
+
+// Write text as a CSV field at out, quoted if it holds a comma, quote or
+// line break, and return the end. Needs at most 2 * size + 2 bytes.
+char* writeCsvField(char* out, string_view text) {
+    if (text.find_first_of(",\"\r\n") == string_view::npos) return copy(text.begin(), text.end(), out);
+    *out++ = '"';
+    for (char c : text) {
+        if (c == '"') *out++ = '"';
+        *out++ = c;
+    }
+    *out++ = '"';
+    return out;
+}
+
+// Upper bound on the team and opponent fields of game i
+size_t csvDimBytes(const GameStore& games, size_t i) {
+    return 2 * (teamDict.name(games.dim(i, DIM_TEAM)).size() + teamDict.name(games.dim(i, DIM_OPPONENT)).size()) + 4;
+}
+
+// Format game i as a CSV row (percentages with two decimals) at out and
+// return the end. Uses to_chars, so no locale or stream state is involved.
+char* formatCsvRow(char* out, const GameStore& games, size_t i) {
+    int32_t v[NUM_STATS];
+    games.values(i, v);
+    out = formatDateTo(out, games.date(i));
+    for (int s = 0; s < NUM_STATS; ++s) {
+        *out++ = ',';
+        out = to_chars(out, out + 12, v[s]).ptr;
+    }
+    for (const ShotDef& d : SHOT_DEFS) {
+        *out++ = ',';
+        out = to_chars(out, out + 24, pct(v[d.made], v[d.attempted]), chars_format::fixed, 2).ptr;
+    }
+    *out++ = ',';
+    out = writeCsvField(out, teamDict.name(games.dim(i, DIM_TEAM)));
+    *out++ = ',';
+    out = writeCsvField(out, teamDict.name(games.dim(i, DIM_OPPONENT)));
+    *out++ = ',';
+    const char* venue = VENUE_NAMES[games.dim(i, DIM_VENUE)];
+    out = copy(venue, venue + strlen(venue), out);
+    *out++ = '\n';
+    return out;
+}
+
+// Append all of p's games as CSV rows in its listing order, each prefixed
+// with prefix (the combined export's player column)
+void appendCsvRows(string& buf, const Player& p, string_view prefix = string_view()) {
+    size_t at = buf.size();
+    buf.resize(at + p.games.size() * (prefix.size() + CSV_ROW_MAX));
+    for (size_t k = 0; k < p.games.size(); ++k) {
+        size_t i = p.shown(k);
+        // Rows with team names may need more than the estimate
+        size_t need = (p.games.size() - k) * (prefix.size() + CSV_ROW_MAX) + (p.games.hasDims(i) ? csvDimBytes(p.games, i) : 0);
+        if (buf.size() - at < need) buf.resize(max(buf.size() * 3 / 2, at + need));
+        char* out = copy(prefix.begin(), prefix.end(), &buf[at]);
+        at = formatCsvRow(out, p.games, i) - buf.data();
+    }
+    buf.resize(at);
+}
+
+// Export a single player's games to CSV (useful for importing into Excel).
+// Rows are formatted into a per-thread buffer that is reused between calls
+// and the file is written with a single write.
+bool exportPlayerToCSV(const Player& p, const string& filename, ostream& log = console) {
+    BSTATS_PROBE(PROBE_EXPORT_CSV);
+    ofstream out(filename);
+    if (!out) {
+        log << "Error opening '" << filename << "' for CSV export.\n\n";
+        return false;
+    }
+    thread_local string buf;
+    // CSV header; rows follow the player's current listing order
+    buf.assign(CSV_HEADER);
+    appendCsvRows(buf, p);
+    out.write(buf.data(), buf.size());
+    BSTATS_BYTES(PROBE_EXPORT_CSV, 0, buf.size());
+    out.close();
+    if (!out) {
+        log << "Error writing CSV file '" << filename << "'.\n\n";
+        return false;
+    }
+    status(log) << "Exported " << p.name << " to CSV file '" << filename << "'.\n\n";
+    return true;
+}
+
+// ======================================================
+// BINARY SNAPSHOT: versioned fixed-layout format, read through a mapping
+// ======================================================
+
+// Layout (little-endian, every section 8-byte aligned):
+//   SnapshotHeader
+//   string table   - all player names back to back, no terminators
+//   player table   - playerCount SnapshotPlayer records
+//   game table     - gameCount SnapshotGame records, grouped by player
+// Records are fixed-size and need no parsing: MappedSnapshot reads names
+// and games straight out of the mapping, and snapshot -> text conversion
+// streams from it in place. Loading into a League copies every game into
+// the player's columnar GameStore, which owns its memory so games can be
+// added, edited and paged out; the mapping is closed after the load.
+const char SNAPSHOT_MAGIC[4] = { 'B', 'S', 'N', 'P' };
+// Version history: 1 = YYYY-MM-DD text dates, 2 = day-number dates,
+// 3 = team table and per-game dimensions (version 2 files still load)
+const uint32_t SNAPSHOT_VERSION = 3;
+
+struct SnapshotHeader {
+    char magic[4];
+    uint32_t version;
+    uint32_t playerCount;
+    uint32_t teamCount;     // version 3; reserved (0) in version 2
+    uint64_t gameCount;
+    uint64_t stringTableOffset;
+    uint64_t stringTableSize;
+    uint64_t playerTableOffset;
+    uint64_t gameTableOffset;
+    // Version 3 only (version 2 headers end before these)
+    uint64_t teamTableOffset;
+    uint64_t dimTableOffset; // gameCount SnapshotDims, parallel to the game table
+};
+
+const size_t SNAPSHOT_V2_HEADER = 56;
+
+struct SnapshotPlayer {
+    uint32_t nameOffset;    // into the string table
+    uint32_t nameLength;
+    uint64_t firstGame;     // index into the game table
+    uint64_t gameCount;
+};
+
+struct SnapshotGame {
+    int32_t date;                   // day number, as in GameStore
+    int32_t stats[NUM_STATS];       // StatId order
+};
+
+// Team i of the file; team ids in SnapshotDims index this table (entry 0
+// is the empty name)
+struct SnapshotTeam {
+    uint32_t nameOffset;    // into the string table
+    uint32_t nameLength;
+};
+
+struct SnapshotDims {
+    uint16_t dims[NUM_DIMS]; // DimId order; team ids index the team table
+};
+
+static_assert(sizeof(SnapshotHeader) == 72, "snapshot header layout");
+static_assert(sizeof(SnapshotPlayer) == 24, "snapshot player layout");
+static_assert(sizeof(SnapshotGame) == 48, "snapshot game layout");
+static_assert(sizeof(SnapshotTeam) == 8, "snapshot team layout");
+static_assert(sizeof(SnapshotDims) == 6, "snapshot dims layout");
+
+// Read-only view of a snapshot file. The file is memory mapped and the
+// accessors point directly into the mapping.
+class MappedSnapshot {
+public:
+    MappedSnapshot() {}
+    MappedSnapshot(const MappedSnapshot&) = delete;
+    MappedSnapshot& operator=(const MappedSnapshot&) = delete;
+    ~MappedSnapshot() { close(); }
+
+    // Map and validate a file; on failure returns false and sets error
+    bool open(const string& filename, string& error) {
+        close();
+#ifdef _WIN32
+        // No mmap here: fall back to reading the file into memory
+        ifstream in(filename, ios::binary | ios::ate);
+        if (!in) { error = "cannot open file"; return false; }
+        fallback.resize((size_t)in.tellg());
+        in.seekg(0);
+        in.read(fallback.data(), fallback.size());
+        base = fallback.data();
+        length = fallback.size();
+#else
+        int fd = ::open(filename.c_str(), O_RDONLY);
+        if (fd < 0) { error = "cannot open file"; return false; }
+        struct stat st;
+        if (fstat(fd, &st) != 0) { ::close(fd); error = "cannot stat file"; return false; }
+        length = (size_t)st.st_size;
+        if (length > 0) {
+            void* m = mmap(nullptr, length, PROT_READ, MAP_PRIVATE, fd, 0);
+            if (m == MAP_FAILED) { ::close(fd); length = 0; error = "mmap failed"; return false; }
+            base = (const char*)m;
+        }
+        ::close(fd); // the mapping stays valid after the descriptor is closed
+#endif
+        if (!validate(error)) { close(); return false; }
+        return true;
+    }
+
+    void close() {
+#ifdef _WIN32
+        fallback.clear();
+#else
+        if (base) munmap((void*)base, length);
+#endif
+        base = nullptr;
+        length = 0;
+    }
+
+    // A copy of the header; the fields a version 2 file lacks read as 0
+    const SnapshotHeader& header() const { return head; }
+    uint32_t playerCount() const { return header().playerCount; }
+    size_t fileSize() const { return length; }
+    uint64_t gameCount() const { return header().gameCount; }
+
+    string_view playerName(uint32_t i) const {
+        const SnapshotPlayer& sp = players()[i];
+        return string_view(base + header().stringTableOffset + sp.nameOffset, sp.nameLength);
+    }
+
+    uint32_t teamCount() const { return header().teamCount; }
+    string_view teamName(uint32_t i) const {
+        const SnapshotTeam& st = ((const SnapshotTeam*)(base + header().teamTableOffset))[i];
+        return string_view(base + header().stringTableOffset + st.nameOffset, st.nameLength);
+    }
+
+    size_t playerGameCount(uint32_t i) const { return (size_t)players()[i].gameCount; }
+    const SnapshotGame* playerGames(uint32_t i) const { return allGames() + players()[i].firstGame; }
+
+    // Dimensions of player i's games, or nullptr if the file has none (version 2)
+    const SnapshotDims* playerDims(uint32_t i) const {
+        if (!header().dimTableOffset) return nullptr;
+        return (const SnapshotDims*)(base + header().dimTableOffset) + players()[i].firstGame;
+    }
+
+private:
+    const SnapshotPlayer* players() const { return (const SnapshotPlayer*)(base + header().playerTableOffset); }
+    const SnapshotGame* allGames() const { return (const SnapshotGame*)(base + header().gameTableOffset); }
+
+    // Check that every table and record the header describes lies inside the file
+    bool validate(string& error) {
+        if (length < SNAPSHOT_V2_HEADER || memcmp(base, SNAPSHOT_MAGIC, 4) != 0) {
+            error = "not a snapshot file";
+            return false;
+        }
+        head = SnapshotHeader();
+        memcpy(&head, base, SNAPSHOT_V2_HEADER);
+        const SnapshotHeader& h = head;
+        if (h.version == 2) {
+            head.teamCount = 0;
+        }
+        else if (h.version != SNAPSHOT_VERSION) {
+            error = "unsupported snapshot version " + to_string(h.version);
+            return false;
+        }
+        else if (length < sizeof(SnapshotHeader)) {
+            error = "truncated or corrupt snapshot";
+            return false;
+        }
+        else {
+            memcpy(&head, base, sizeof(SnapshotHeader));
+        }
+        auto fits = [&](uint64_t off, uint64_t count, uint64_t size) {
+            return off <= length && (size == 0 || count <= (length - off) / size);
+            };
+        if (!fits(h.stringTableOffset, h.stringTableSize, 1)
+            || !fits(h.playerTableOffset, h.playerCount, sizeof(SnapshotPlayer))
+            || !fits(h.gameTableOffset, h.gameCount, sizeof(SnapshotGame))
+            || h.playerTableOffset % 8 != 0 || h.gameTableOffset % 8 != 0
+            || (h.version >= 3 && (!fits(h.teamTableOffset, h.teamCount, sizeof(SnapshotTeam))
+                || !fits(h.dimTableOffset, h.gameCount, sizeof(SnapshotDims))
+                || h.teamTableOffset % 8 != 0 || h.dimTableOffset % 8 != 0 || h.dimTableOffset == 0))) {
+            error = "truncated or corrupt snapshot";
+            return false;
+        }
+        for (uint32_t i = 0; i < h.teamCount; ++i) {
+            const SnapshotTeam& st = ((const SnapshotTeam*)(base + h.teamTableOffset))[i];
+            if ((uint64_t)st.nameOffset + st.nameLength > h.stringTableSize) {
+                error = "corrupt team record " + to_string(i);
+                return false;
+            }
+        }
+        for (uint32_t i = 0; i < h.playerCount; ++i) {
+            const SnapshotPlayer& sp = players()[i];
+            if ((uint64_t)sp.nameOffset + sp.nameLength > h.stringTableSize
+                || sp.firstGame > h.gameCount || sp.gameCount > h.gameCount - sp.firstGame) {
+                error = "corrupt player record " + to_string(i + 1);
+                return false;
+            }
+        }
+        return true;
+    }
+
+    const char* base = nullptr;
+    size_t length = 0;
+    SnapshotHeader head = {};
+#ifdef _WIN32
+    vector<char> fallback;
+#endif
+};
+
+// Round up to the next multiple of 8
+uint64_t align8(uint64_t x) { return (x + 7) & ~(uint64_t)7; }
+
+// Save all players in the binary snapshot format
+bool saveSnapshot(const vector<Player>& players, const string& filename, ostream& log = console) {
+    BSTATS_PROBE(PROBE_SAVE_SNAPSHOT);
+    SnapshotHeader h = {};
+    memcpy(h.magic, SNAPSHOT_MAGIC, sizeof(h.magic));
+    h.version = SNAPSHOT_VERSION;
+    h.playerCount = (uint32_t)players.size();
+
+    vector<SnapshotPlayer> table(players.size());
+    string names;
+    uint64_t gameCount = 0;
+    for (size_t i = 0; i < players.size(); ++i) {
+        table[i].nameOffset = (uint32_t)names.size();
+        table[i].nameLength = (uint32_t)players[i].name.size();
+        table[i].firstGame = gameCount;
+        table[i].gameCount = players[i].games.size();
+        names += players[i].name;
+        gameCount += players[i].games.size();
+    }
+    // The whole team dictionary, so game dims store dictionary ids as they are
+    vector<SnapshotTeam> teams(teamDict.size());
+    for (uint32_t t = 0; t < teams.size(); ++t) {
+        string_view team = teamDict.name((uint16_t)t);
+        teams[t].nameOffset = (uint32_t)names.size();
+        teams[t].nameLength = (uint32_t)team.size();
+        names += team;
+    }
+    h.gameCount = gameCount;
+    h.teamCount = (uint32_t)teams.size();
+    h.stringTableOffset = sizeof(SnapshotHeader);
+    h.stringTableSize = names.size();
+    h.playerTableOffset = align8(h.stringTableOffset + h.stringTableSize);
+    h.teamTableOffset = align8(h.playerTableOffset + table.size() * sizeof(SnapshotPlayer));
+    h.gameTableOffset = align8(h.teamTableOffset + teams.size() * sizeof(SnapshotTeam));
+    h.dimTableOffset = align8(h.gameTableOffset + gameCount * sizeof(SnapshotGame));
+
+    ofstream out(tempFileFor(filename), ios::binary);
+    if (!out) {
+        log << "Error opening '" << filename << "' for writing.\n\n";
+        return false;
+    }
+    const char zeros[8] = {};
+    out.write((const char*)&h, sizeof(h));
+    out.write(names.data(), names.size());
+    out.write(zeros, h.playerTableOffset - (h.stringTableOffset + h.stringTableSize));
+    out.write((const char*)table.data(), table.size() * sizeof(SnapshotPlayer));
+    out.write(zeros, h.teamTableOffset - (h.playerTableOffset + table.size() * sizeof(SnapshotPlayer)));
+    out.write((const char*)teams.data(), teams.size() * sizeof(SnapshotTeam));
+    out.write(zeros, h.gameTableOffset - (h.teamTableOffset + teams.size() * sizeof(SnapshotTeam)));
+
+    // Games go out in batches to keep the number of write calls low
+    vector<SnapshotGame> batch;
+    batch.reserve(4096);
+    for (const auto& p : players) {
+        for (size_t j = 0; j < p.games.size(); ++j) {
+            SnapshotGame rec = {};
+            rec.date = p.games.date(j);
+            for (int s = 0; s < NUM_STATS; ++s) rec.stats[s] = p.games.stat(j, (StatId)s);
+            batch.push_back(rec);
+            if (batch.size() == batch.capacity()) {
+                out.write((const char*)batch.data(), batch.size() * sizeof(SnapshotGame));
+                batch.clear();
+            }
+        }
+    }
+    out.write((const char*)batch.data(), batch.size() * sizeof(SnapshotGame));
+    out.write(zeros, h.dimTableOffset - (h.gameTableOffset + gameCount * sizeof(SnapshotGame)));
+    vector<SnapshotDims> dims;
+    dims.reserve(4096);
+    for (const auto& p : players) {
+        for (size_t j = 0; j < p.games.size(); ++j) {
+            dims.emplace_back();
+            p.games.dims(j, dims.back().dims);
+            if (dims.size() == dims.capacity()) {
+                out.write((const char*)dims.data(), dims.size() * sizeof(SnapshotDims));
+                dims.clear();
+            }
+        }
+    }
+    out.write((const char*)dims.data(), dims.size() * sizeof(SnapshotDims));
+    BSTATS_BYTES(PROBE_SAVE_SNAPSHOT, 0, h.dimTableOffset + gameCount * sizeof(SnapshotDims));
+    out.close();
+    if (!out || !commitTempFile(filename)) {
+        log << "Error writing '" << filename << "'.\n\n";
+        remove(tempFileFor(filename).c_str());
+        return false;
+    }
+    status(log) << "Saved snapshot of " << players.size() << " players to '" << filename << "'.\n\n";
+    return true;
+}
+
+// Load every player from a snapshot into the in-memory columnar store,
+// replacing the league or merging into it like loadAllPlayersFromFile.
+// This copies the games out of the mapping (see the layout note above);
+// the win over the text format is that nothing is parsed.
+bool loadSnapshot(League& league, const string& filename, ostream& log = console, bool merge = false) {
+    BSTATS_PROBE(PROBE_LOAD_SNAPSHOT);
+    MappedSnapshot snap;
+    string error;
+    if (!snap.open(filename, error)) {
+        log << "Cannot load snapshot '" << filename << "': " << error << ".\n\n";
+        return false;
+    }
+    BSTATS_BYTES(PROBE_LOAD_SNAPSHOT, snap.fileSize(), 0);
+    // File team ids -> ids in this run's teamDict
+    vector<uint16_t> teamIds(snap.teamCount());
+    for (uint32_t t = 0; t < snap.teamCount(); ++t) {
+        if (!teamDict.idOf(snap.teamName(t), teamIds[t])) {
+            log << "Cannot load snapshot '" << filename << "': " << TeamDictionary::FULL_ERROR << ".\n\n";
+            return false;
+        }
+    }
+    vector<Player> loaded;
+    loaded.reserve(snap.playerCount());
+    uint16_t d[NUM_DIMS];
+    for (uint32_t i = 0; i < snap.playerCount(); ++i) {
+        loaded.emplace_back(snap.playerName(i));
+        Player& p = loaded.back();
+        const SnapshotGame* games = snap.playerGames(i);
+        const SnapshotDims* dims = snap.playerDims(i);
+        size_t n = snap.playerGameCount(i);
+        p.games.reserve(n);
+        for (size_t j = 0; j < n; ++j) {
+            if (dims) {
+                for (int k = 0; k < NUM_DIMS; ++k) {
+                    uint16_t v = dims[j].dims[k];
+                    if (k != DIM_VENUE ? v >= teamIds.size() : v > VENUE_AWAY) {
+                        log << "Cannot load snapshot '" << filename << "': corrupt game dimensions in player " << i + 1 << ".\n\n";
+                        return false;
+                    }
+                    d[k] = k == DIM_VENUE ? v : teamIds[v];
+                }
+            }
+            p.games.appendUntracked(games[j].date, games[j].stats, dims ? d : nullptr);
+        }
+        p.games.retotal();
+    }
+    status(log) << mergeLoaded(league, loaded, merge) << " players from snapshot.\n\n";
+    return true;
+}
+
+// ======================================================
+// COMPRESSED ARCHIVE: delta-coded dates, bit-packed stat columns
+// ======================================================
+
+// Layout (little-endian):
+//   ArchiveHeader
+//   string table  - all player names, then all team names, back to back
+//                   with no terminators
+//   player table  - playerCount ArchivePlayer records
+//   block index   - blockCount ArchiveBlock records, grouped by player
+//   team table    - teamCount ArchiveTeam records (version 2)
+//   block data    - one compressed block per index entry
+// A block is a run of one player's games in list order, all from one
+// season and at most ARCHIVE_BLOCK_GAMES long. Inside it the dates are
+// zigzag varint deltas from the previous game (the first from firstDate),
+// then each stat column in StatId order is its minimum (zigzag varint), a
+// bit width byte and every value minus the minimum packed at that width.
+// Version 2 follows the stats with each dimension column in DimId order,
+// packed the same way; team ids index the team table.
+// The index lets a reader fetch just the blocks of one player or season.
+const char ARCHIVE_MAGIC[4] = { 'B', 'A', 'R', 'C' };
+const uint32_t ARCHIVE_VERSION = 2;
+const size_t ARCHIVE_BLOCK_GAMES = 4096;
+
+struct ArchiveHeader {
+    char magic[4];
+    uint32_t version;
+    uint32_t playerCount;
+    uint32_t blockCount;
+    uint64_t gameCount;
+    uint64_t stringTableSize;
+    uint64_t dataOffset;    // start of the block data
+    uint64_t dataSize;
+    // Version 2 only (version 1 headers end before these)
+    uint32_t teamCount;
+    uint32_t reserved;
+};
+
+const size_t ARCHIVE_V1_HEADER = 48;
+
+struct ArchivePlayer {
+    uint32_t nameOffset;    // into the string table
+    uint32_t nameLength;
+    uint32_t firstBlock;    // index into the block index
+    uint32_t blockCount;
+};
+
+struct ArchiveBlock {
+    uint64_t offset;        // from the start of the block data
+    uint32_t size;
+    uint32_t gameCount;
+    int32_t season;         // seasonOf() every game in the block
+    int32_t firstDate;
+    uint32_t checksum;      // checksum32 of the block bytes
+    uint32_t reserved;
+};
+
+struct ArchiveTeam {
+    uint32_t nameOffset;    // into the string table
+    uint32_t nameLength;
+};
+
+static_assert(sizeof(ArchiveHeader) == 56, "archive header layout");
+static_assert(sizeof(ArchivePlayer) == 16, "archive player layout");
+static_assert(sizeof(ArchiveBlock) == 32, "archive block layout");
+static_assert(sizeof(ArchiveTeam) == 8, "archive team layout");
+
+uint64_t zigzag(int64_t v) { return ((uint64_t)v << 1) ^ (uint64_t)(v >> 63); }
+int64_t unzigzag(uint64_t v) { return (int64_t)(v >> 1) ^ -(int64_t)(v & 1); }
+
+void putVarint(string& out, uint64_t v) {
+    while (v >= 0x80) { out += (char)(v | 0x80); v >>= 7; }
+    out += (char)v;
+}
+
+// Read one varint at p, advancing it; false if it runs past end
+bool getVarint(const char*& p, const char* end, uint64_t& v) {
+    v = 0;
+    for (int shift = 0; p < end && shift < 64; shift += 7) {
+        uint8_t b = (uint8_t)*p++;
+        v |= (uint64_t)(b & 0x7f) << shift;
+        if (!(b & 0x80)) return true;
+    }
+    return false;
+}
+
+// Append n values of width bits each (width <= 32), least significant first
+void packBits(string& out, const uint32_t* v, size_t n, int width) {
+    uint64_t acc = 0;
+    int bits = 0;
+    for (size_t i = 0; i < n; ++i) {
+        acc |= (uint64_t)v[i] << bits;
+        for (bits += width; bits >= 8; bits -= 8) { out += (char)acc; acc >>= 8; }
+    }
+    if (bits > 0) out += (char)acc;
+}
+
+// Inverse of packBits, advancing p; false if the data runs past end
+bool unpackBits(const char*& p, const char* end, uint32_t* v, size_t n, int width) {
+    size_t bytes = (n * width + 7) / 8;
+    if ((size_t)(end - p) < bytes) return false;
+    const uint8_t* b = (const uint8_t*)p;
+    const uint64_t mask = (1ULL << width) - 1;
+    uint64_t acc = 0;
+    int bits = 0;
+    for (size_t i = 0; i < n; ++i) {
+        for (; bits < width; bits += 8) acc |= (uint64_t)*b++ << bits;
+        v[i] = (uint32_t)(acc & mask);
+        acc >>= width;
+        bits -= width;
+    }
+    p += bytes;
+    return true;
+}
+
+// Append one column as its minimum, a bit width byte and the packed offsets
+template<class T>
+void packColumn(string& out, const T* col, size_t n, vector<uint32_t>& packed) {
+    int64_t lo = *min_element(col, col + n), hi = *max_element(col, col + n);
+    uint32_t range = (uint32_t)(hi - lo);
+    int width = 0;
+    while (width < 32 && (range >> width) != 0) ++width;
+    putVarint(out, zigzag(lo));
+    out += (char)width;
+    for (size_t j = 0; j < n; ++j) packed[j] = (uint32_t)((int64_t)col[j] - lo);
+    packBits(out, packed.data(), n, width);
+}
+
+// Compress games [first, first + n) of g onto out
+void encodeArchiveBlock(const GameStore& g, size_t first, size_t n, string& out) {
+    int64_t prev = g.date(first);
+    for (size_t j = first; j < first + n; ++j) {
+        putVarint(out, zigzag(g.date(j) - prev));
+        prev = g.date(j);
+    }
+    vector<uint32_t> packed(n);
+    for (int s = 0; s < NUM_STATS; ++s) packColumn(out, g.column((StatId)s) + first, n, packed);
+    for (int k = 0; k < NUM_DIMS; ++k) packColumn(out, g.dimColumn((DimId)k) + first, n, packed);
+}
+
+// Decompress one block and append its games to g; false if it is corrupt.
+// teamIds maps the file's team ids to teamDict ids; a version 1 archive
+// has no team table and no dimension columns.
+bool decodeArchiveBlock(const char* p, size_t size, const ArchiveBlock& b, uint32_t version,
+    const vector<uint16_t>& teamIds, GameStore& g) {
+    const char* end = p + size;
+    size_t n = b.gameCount;
+    vector<int32_t> rows(n * (NUM_STATS + 1)); // date then stats, one row per game
+    vector<uint16_t> dims(version >= 2 ? n * NUM_DIMS : 0);
+    vector<uint32_t> packed(n);
+    int64_t date = b.firstDate;
+    uint64_t v;
+    for (size_t j = 0; j < n; ++j) {
+        if (!getVarint(p, end, v)) return false;
+        date += unzigzag(v);
+        if (date < INT32_MIN || date > INT32_MAX) return false;
+        rows[j * (NUM_STATS + 1)] = (int32_t)date;
+    }
+    for (int s = 0; s < NUM_STATS; ++s) {
+        if (!getVarint(p, end, v) || p == end) return false;
+        int64_t lo = unzigzag(v);
+        int width = (uint8_t)*p++;
+        if (width > 32 || !unpackBits(p, end, packed.data(), n, width)) return false;
+        for (size_t j = 0; j < n; ++j) {
+            int64_t x = lo + packed[j];
+            if (x < INT32_MIN || x > INT32_MAX) return false;
+            rows[j * (NUM_STATS + 1) + 1 + s] = (int32_t)x;
+        }
+    }
+    for (int k = 0; !dims.empty() && k < NUM_DIMS; ++k) {
+        if (!getVarint(p, end, v) || p == end) return false;
+        int64_t lo = unzigzag(v);
+        int width = (uint8_t)*p++;
+        if (width > 16 || !unpackBits(p, end, packed.data(), n, width)) return false;
+        for (size_t j = 0; j < n; ++j) {
+            int64_t x = lo + packed[j];
+            if (k == DIM_VENUE ? x < 0 || x > VENUE_AWAY : x < 0 || x >= (int64_t)teamIds.size()) return false;
+            dims[j * NUM_DIMS + k] = k == DIM_VENUE ? (uint16_t)x : teamIds[x];
+        }
+    }
+    if (p != end) return false;
+    for (size_t j = 0; j < n; ++j) {
+        g.appendUntracked(rows[j * (NUM_STATS + 1)], &rows[j * (NUM_STATS + 1) + 1],
+            dims.empty() ? nullptr : &dims[j * NUM_DIMS]);
+    }
+    return true;
+}
+
+// Save all players in the compressed archive format
+bool saveArchive(const vector<Player>& players, const string& filename, ostream& log = console) {
+    BSTATS_PROBE(PROBE_SAVE_ARCHIVE);
+    ArchiveHeader h = {};
+    memcpy(h.magic, ARCHIVE_MAGIC, sizeof(h.magic));
+    h.version = ARCHIVE_VERSION;
+    h.playerCount = (uint32_t)players.size();
+
+    vector<ArchivePlayer> table(players.size());
+    vector<ArchiveBlock> blocks;
+    string names, data;
+    for (size_t i = 0; i < players.size(); ++i) {
+        const GameStore& g = players[i].games;
+        table[i].nameOffset = (uint32_t)names.size();
+        table[i].nameLength = (uint32_t)players[i].name.size();
+        table[i].firstBlock = (uint32_t)blocks.size();
+        names += players[i].name;
+        // Cut a block at each change of season and every ARCHIVE_BLOCK_GAMES games
+        for (size_t j = 0; j < g.size();) {
+            ArchiveBlock b = {};
+            b.offset = data.size();
+            b.season = seasonOf(g.date(j));
+            b.firstDate = g.date(j);
+            int32_t seasonStart = daysFromCivil(b.season, 8, 1), seasonEnd = daysFromCivil(b.season + 1, 8, 1);
+            size_t k = j + 1;
+            while (k < g.size() && k - j < ARCHIVE_BLOCK_GAMES && g.date(k) >= seasonStart && g.date(k) < seasonEnd) ++k;
+            encodeArchiveBlock(g, j, k - j, data);
+            b.gameCount = (uint32_t)(k - j);
+            b.size = (uint32_t)(data.size() - b.offset);
+            b.checksum = checksum32(data.data() + b.offset, b.size);
+            blocks.push_back(b);
+            j = k;
+        }
+        table[i].blockCount = (uint32_t)(blocks.size() - table[i].firstBlock);
+        h.gameCount += g.size();
+    }
+    // The whole team dictionary, so blocks store dictionary ids as they are
+    vector<ArchiveTeam> teams(teamDict.size());
+    for (uint32_t t = 0; t < teams.size(); ++t) {
+        string_view team = teamDict.name((uint16_t)t);
+        teams[t].nameOffset = (uint32_t)names.size();
+        teams[t].nameLength = (uint32_t)team.size();
+        names += team;
+    }
+    h.blockCount = (uint32_t)blocks.size();
+    h.teamCount = (uint32_t)teams.size();
+    h.stringTableSize = names.size();
+    h.dataOffset = sizeof(h) + names.size() + table.size() * sizeof(ArchivePlayer) + blocks.size() * sizeof(ArchiveBlock)
+        + teams.size() * sizeof(ArchiveTeam);
+    h.dataSize = data.size();
+
+    ofstream out(tempFileFor(filename), ios::binary);
+    if (!out) {
+        log << "Error opening '" << filename << "' for writing.\n\n";
+        return false;
+    }
+    out.write((const char*)&h, sizeof(h));
+    out.write(names.data(), names.size());
+    out.write((const char*)table.data(), table.size() * sizeof(ArchivePlayer));
+    out.write((const char*)blocks.data(), blocks.size() * sizeof(ArchiveBlock));
+    out.write((const char*)teams.data(), teams.size() * sizeof(ArchiveTeam));
+    out.write(data.data(), data.size());
+    BSTATS_BYTES(PROBE_SAVE_ARCHIVE, 0, h.dataOffset + h.dataSize);
+    out.close();
+    if (!out || !commitTempFile(filename)) {
+        log << "Error writing '" << filename << "'.\n\n";
+        remove(tempFileFor(filename).c_str());
+        return false;
+    }
+    status(log) << "Saved archive of " << players.size() << " players (" << h.gameCount << " games, "
+        << h.dataOffset + h.dataSize << " bytes) to '" << filename << "'.\n\n";
+    return true;
+}
+
+// Which part of an archive to load; the defaults load everything
+struct ArchiveFilter {
+    string player;              // empty = every player
+    int32_t season = INT32_MIN; // INT32_MIN = every season
+};
+
+// An archive's header, names, player table and block index: everything
+// but the block data. in is left open for readArchivePlayer.
+struct ArchiveIndex {
+    ArchiveHeader header = {};
+    string names;
+    vector<ArchivePlayer> players;
+    vector<ArchiveBlock> blocks;
+    vector<uint16_t> teamIds;   // file team id -> teamDict id
+
+    string_view name(uint32_t i) const { return string_view(names.data() + players[i].nameOffset, players[i].nameLength); }
+};
+
+// Read and validate the index of an archive; on failure returns false and sets error
+bool readArchiveIndex(ifstream& in, const string& filename, ArchiveIndex& index, string& error) {
+    in.open(filename, ios::binary | ios::ate);
+    if (!in) { error = "cannot open file"; return false; }
+    uint64_t length = (uint64_t)in.tellg();
+    in.seekg(0);
+    ArchiveHeader& h = index.header;
+    h = ArchiveHeader();
+    if (length < ARCHIVE_V1_HEADER || !in.read((char*)&h, ARCHIVE_V1_HEADER) || memcmp(h.magic, ARCHIVE_MAGIC, 4) != 0) {
+        error = "not an archive file";
+        return false;
+    }
+    if (h.version != 1 && h.version != ARCHIVE_VERSION) { error = "unsupported archive version " + to_string(h.version); return false; }
+    uint64_t headerBytes = h.version >= 2 ? sizeof(h) : ARCHIVE_V1_HEADER;
+    if (h.version >= 2 && (length < sizeof(h) || !in.read((char*)&h + ARCHIVE_V1_HEADER, sizeof(h) - ARCHIVE_V1_HEADER))) {
+        error = "truncated or corrupt archive";
+        return false;
+    }
+    uint64_t indexBytes = h.stringTableSize + (uint64_t)h.playerCount * sizeof(ArchivePlayer)
+        + (uint64_t)h.blockCount * sizeof(ArchiveBlock) + (uint64_t)h.teamCount * sizeof(ArchiveTeam);
+    if (indexBytes > length - headerBytes || h.dataOffset != headerBytes + indexBytes
+        || h.dataSize > length - h.dataOffset) {
+        error = "truncated or corrupt archive";
+        return false;
+    }
+    index.names.assign(h.stringTableSize, '\0');
+    index.players.resize(h.playerCount);
+    index.blocks.resize(h.blockCount);
+    in.read(index.names.data(), index.names.size());
+    in.read((char*)index.players.data(), index.players.size() * sizeof(ArchivePlayer));
+    in.read((char*)index.blocks.data(), index.blocks.size() * sizeof(ArchiveBlock));
+    vector<ArchiveTeam> teams(h.teamCount);
+    in.read((char*)teams.data(), teams.size() * sizeof(ArchiveTeam));
+    if (!in) { error = "truncated archive index"; return false; }
+    index.teamIds.resize(teams.size());
+    for (uint32_t t = 0; t < teams.size(); ++t) {
+        if ((uint64_t)teams[t].nameOffset + teams[t].nameLength > index.names.size()) {
+            error = "corrupt team record " + to_string(t);
+            return false;
+        }
+        if (!teamDict.idOf(string_view(index.names.data() + teams[t].nameOffset, teams[t].nameLength), index.teamIds[t])) {
+            error = TeamDictionary::FULL_ERROR;
+            return false;
+        }
+    }
+    for (uint32_t i = 0; i < h.playerCount; ++i) {
+        const ArchivePlayer& ap = index.players[i];
+        if ((uint64_t)ap.nameOffset + ap.nameLength > index.names.size()
+            || ap.firstBlock > h.blockCount || ap.blockCount > h.blockCount - ap.firstBlock) {
+            error = "corrupt player record " + to_string(i + 1);
+            return false;
+        }
+    }
+    // The block checksums cover only the block bytes, so the counts readers
+    // allocate from are checked here: every game takes at least its date
+    // byte in the block, and the blocks must add up to the header's total
+    uint64_t games = 0;
+    for (const ArchiveBlock& b : index.blocks) {
+        if (b.offset > h.dataSize || b.size > h.dataSize - b.offset || b.gameCount == 0
+            || b.gameCount > ARCHIVE_BLOCK_GAMES || b.gameCount > b.size) {
+            error = "corrupt block index";
+            return false;
+        }
+        games += b.gameCount;
+    }
+    if (games != h.gameCount) { error = "corrupt block index"; return false; }
+    return true;
+}
+
+// Games in player i's blocks from season (INT32_MIN = every season)
+size_t archiveGameCount(const ArchiveIndex& index, uint32_t i, int32_t season = INT32_MIN) {
+    const ArchivePlayer& ap = index.players[i];
+    size_t games = 0;
+    for (uint32_t b = ap.firstBlock; b < ap.firstBlock + ap.blockCount; ++b) {
+        if (season == INT32_MIN || index.blocks[b].season == season) games += index.blocks[b].gameCount;
+    }
+    return games;
+}
+
+// Read player i's blocks from season (INT32_MIN = every season) and append
+// their games to g; adds the bytes read to bytesRead
+bool readArchivePlayer(ifstream& in, const ArchiveIndex& index, uint32_t i, int32_t season, GameStore& g,
+    uint64_t& bytesRead, string& error) {
+    const ArchivePlayer& ap = index.players[i];
+    g.reserve(g.size() + archiveGameCount(index, i, season));
+    string buf;
+    for (uint32_t b = ap.firstBlock; b < ap.firstBlock + ap.blockCount; ++b) {
+        const ArchiveBlock& blk = index.blocks[b];
+        if (season != INT32_MIN && blk.season != season) continue;
+        buf.resize(blk.size);
+        in.clear();
+        in.seekg(index.header.dataOffset + blk.offset);
+        if (!in.read(buf.data(), buf.size()) || checksum32(buf.data(), buf.size()) != blk.checksum
+            || !decodeArchiveBlock(buf.data(), buf.size(), blk, index.header.version, index.teamIds, g)) {
+            error = "corrupt block " + to_string(b - ap.firstBlock + 1) + " of player '" + string(index.name(i)) + "'";
+            return false;
+        }
+        bytesRead += blk.size;
+    }
+    g.retotal();
+    return true;
+}
+
+// Load players from an archive, replacing the league or merging into it
+// like loadAllPlayersFromFile. Only the index and the blocks that pass
+// filter are read; with a season filter, players without games in that
+// season are left out.
+bool loadArchive(League& league, const string& filename, ostream& log = console, bool merge = false,
+    const ArchiveFilter& filter = ArchiveFilter()) {
+    BSTATS_PROBE(PROBE_LOAD_ARCHIVE);
+    ifstream in;
+    ArchiveIndex index;
+    string error;
+    uint64_t bytesRead = 0;
+    vector<Player> loaded;
+    bool ok = readArchiveIndex(in, filename, index, error);
+    for (uint32_t i = 0; ok && i < index.header.playerCount; ++i) {
+        if (!filter.player.empty() && index.name(i) != filter.player) continue;
+        if (filter.season != INT32_MIN && archiveGameCount(index, i, filter.season) == 0) continue;
+        loaded.emplace_back(index.name(i));
+        ok = readArchivePlayer(in, index, i, filter.season, loaded.back().games, bytesRead, error);
+    }
+    if (!ok) {
+        log << "Cannot load archive '" << filename << "': " << error << ".\n\n";
+        return false;
+    }
+    BSTATS_BYTES(PROBE_LOAD_ARCHIVE, index.header.dataOffset + bytesRead, 0);
+    if (!filter.player.empty() && loaded.empty()) {
+        log << "No player named '" << filter.player << "' in archive '" << filename << "'.\n\n";
+        return false;
+    }
+    status(log) << mergeLoaded(league, loaded, merge) << " players from archive.\n\n";
+    return true;
+}
+
+// ======================================================
+// COMPACT STORAGE: every player's games packed in one pool
+// ======================================================
+
+// Keep games packed in a GamePool between uses instead of as int32
+// columns (--compact); see compactLeague
+bool compactMode = false;
+
+// Columns of a pooled player, in order: the date (as days after the
+// player's earliest game), the NUM_STATS stats and the NUM_DIMS dimensions
+const int POOL_COLUMNS = 1 + NUM_STATS + NUM_DIMS;
+
+// A value that does not fit its narrow column, kept whole
+struct PoolEscape {
+    uint32_t game;
+    int32_t value; // the stat or dimension id; the full day number for the date
+};
+
+// Where a player's games sit in the pool. Column c is stored as uint16 if
+// bit c of wide is set and as uint8 otherwise. A stored value equal to the
+// width's maximum is an escape: the real value is the next entry of the
+// player's escapes, which are kept column by column in game order.
+struct PoolEntry {
+    uint64_t offset = 0;      // first byte in GamePool::bytes
+    uint32_t games = 0;
+    uint32_t firstEscape = 0; // index in GamePool::escapes
+    int32_t baseDate = 0;
+    uint32_t wide = 0;        // one bit per column
+};
+
+static_assert(POOL_COLUMNS <= 32, "pool column mask");
+
+// Packed games of every player of a league. All players share one byte
+// buffer and one escape list, so there is no per-player allocation or
+// slack capacity; box-score values almost always fit in a byte.
+struct GamePool {
+    vector<uint8_t> bytes;
+    vector<PoolEscape> escapes;
+    vector<PoolEntry> players; // by player index
+
+    size_t games() const {
+        size_t n = 0;
+        for (const PoolEntry& e : players) n += e.games;
+        return n;
+    }
+
+    size_t memoryBytes() const {
+        return bytes.capacity() + escapes.capacity() * sizeof(PoolEscape) + players.capacity() * sizeof(PoolEntry);
+    }
+};
+
+// Value of pool column c for game i of g
+int64_t poolValue(const GameStore& g, int c, size_t i, int32_t baseDate) {
+    if (c == 0) return (int64_t)g.date(i) - baseDate;
+    if (c <= NUM_STATS) return g.stat(i, (StatId)(c - 1));
+    return g.dim(i, (DimId)(c - 1 - NUM_STATS));
+}
+
+// Append g's games to the pool as the next player. Each column is uint8
+// unless uint16 takes fewer bytes once its escapes are counted.
+void poolPlayer(GamePool& pool, const GameStore& g) {
+    PoolEntry e;
+    size_t n = g.size();
+    e.offset = pool.bytes.size();
+    e.games = (uint32_t)n;
+    e.firstEscape = (uint32_t)pool.escapes.size();
+    e.baseDate = n ? *min_element(g.dateColumn(), g.dateColumn() + n) : 0;
+    for (int c = 0; c < POOL_COLUMNS; ++c) {
+        size_t over8 = 0, over16 = 0;
+        for (size_t i = 0; i < n; ++i) {
+            int64_t v = poolValue(g, c, i, e.baseDate);
+            over8 += v < 0 || v >= UINT8_MAX;
+            over16 += v < 0 || v >= UINT16_MAX;
+        }
+        bool wide = n * 2 + over16 * sizeof(PoolEscape) < n + over8 * sizeof(PoolEscape);
+        int64_t escape = wide ? UINT16_MAX : UINT8_MAX;
+        size_t at = pool.bytes.size();
+        pool.bytes.resize(at + n * (wide ? 2 : 1));
+        uint8_t* out = pool.bytes.data() + at;
+        for (size_t i = 0; i < n; ++i) {
+            int64_t v = poolValue(g, c, i, e.baseDate);
+            bool escaped = v < 0 || v >= escape;
+            if (escaped) pool.escapes.push_back({ (uint32_t)i, c == 0 ? g.date(i) : (int32_t)v });
+            uint16_t stored = (uint16_t)(escaped ? escape : v);
+            if (wide) memcpy(out + 2 * i, &stored, 2);
+            else out[i] = (uint8_t)stored;
+        }
+        if (wide) e.wide |= 1u << c;
+    }
+    pool.players.push_back(e);
+}
+
+// Decode player p's games from the pool into g
+void unpoolPlayer(const GamePool& pool, size_t p, GameStore& g) {
+    const PoolEntry& e = pool.players[p];
+    size_t n = e.games;
+    vector<int32_t> rows(n * POOL_COLUMNS); // one row per game, in column order
+    const uint8_t* at = pool.bytes.data() + e.offset;
+    const PoolEscape* escape = pool.escapes.data() + e.firstEscape;
+    for (int c = 0; c < POOL_COLUMNS; ++c) {
+        bool wide = (e.wide >> c) & 1;
+        uint32_t code = wide ? UINT16_MAX : UINT8_MAX;
+        for (size_t i = 0; i < n; ++i) {
+            uint16_t stored = at[i];
+            if (wide) memcpy(&stored, at + 2 * i, 2);
+            int32_t v = stored == code ? (escape++)->value : c == 0 ? e.baseDate + stored : stored;
+            rows[i * POOL_COLUMNS + c] = v;
+        }
+        at += n * (wide ? 2 : 1);
+    }
+    g.reserve(n);
+    for (size_t i = 0; i < n; ++i) {
+        const int32_t* row = &rows[i * POOL_COLUMNS];
+        uint16_t dims[NUM_DIMS];
+        for (int k = 0; k < NUM_DIMS; ++k) dims[k] = (uint16_t)row[1 + NUM_STATS + k];
+        g.appendUntracked(row[0], row + 1, dims);
+    }
+    g.retotal();
+}
+
+// ======================================================
+// LAZY LOADING: archive or pooled players paged in on first use
+// ======================================================
+
+// Memory budget in bytes for the games of lazily loaded players
+// (--memory-budget); 0 = no limit
+size_t memoryBudget = 0;
+
+// How a caller uses a paged-in player: TOUCH leaves it evictable, HOLD keeps
+// it resident until release(), PIN keeps it for good (it may be edited)
+enum PageUse { PAGE_TOUCH, PAGE_HOLD, PAGE_PIN };
+
+// The open archive behind a lazily loaded league, or the GamePool of a
+// compacted one. Opening an archive reads only the index; a player's games
+// are read from their blocks (or decoded from the pool) the first time they
+// are needed. Resident players that are neither held nor pinned are kept in
+// LRU order, and the least recently used are dropped again whenever the
+// resident games exceed memoryBudget; a pooled league without a budget keeps
+// only the players in use decoded. Players added after opening are ordinary
+// in-memory players.
+struct PlayerPager {
+    enum State : uint8_t { OUT, IN, HELD, PINNED };
+
+    string filename;
+    ifstream in;
+    ArchiveIndex index;
+    bool pooled = false;                // games come from pool, not the archive
+    GamePool pool;
+    vector<State> state;                // per archive player
+    vector<size_t> bytes;               // memory charged while resident
+    list<int> lru;                      // players in state IN, most recent first
+    vector<list<int>::iterator> lruPos;
+    size_t residentBytes = 0;
+};
+
+size_t gameCount(const League& league, int idx) {
+    const PlayerPager* pg = league.pager.get();
+    if (pg && (size_t)idx < pg->state.size() && pg->state[idx] == PlayerPager::OUT) {
+        return pg->pooled ? pg->pool.players[idx].games : archiveGameCount(pg->index, (uint32_t)idx);
+    }
+    return league.players[idx].games.size();
+}
+
+// Drop player idx's games; they are read again on next use
+void evictPlayer(League& league, int idx) {
+    PlayerPager& pg = *league.pager;
+    Player& p = league.players[idx];
+    p.games = GameStore();
+    p.byDate = DateQueryIndex();
+    p.view = Player::VIEW_STORAGE;
+    pg.lru.erase(pg.lruPos[idx]);
+    pg.residentBytes -= pg.bytes[idx];
+    pg.bytes[idx] = 0;
+    pg.state[idx] = PlayerPager::OUT;
+}
+
+// True while the evictable resident players should shrink (see PlayerPager)
+bool overBudget(const PlayerPager& pg) {
+    return memoryBudget > 0 ? pg.residentBytes > memoryBudget : pg.pooled && pg.residentBytes > 0;
+}
+
+// Make player idx resident for the given use, evicting cold players if the
+// budget is exceeded. False (with a message on log) if its blocks cannot be read.
+bool pageIn(League& league, int idx, PageUse use = PAGE_TOUCH, ostream& log = console) {
+    PlayerPager* pg = league.pager.get();
+    if (!pg || (size_t)idx >= pg->state.size()) return true;
+    PlayerPager::State& st = pg->state[idx];
+    if (st == PlayerPager::OUT) {
+        BSTATS_PROBE(PROBE_PAGE_IN);
+        uint64_t read = 0;
+        string error;
+        if (pg->pooled) unpoolPlayer(pg->pool, idx, league.players[idx].games);
+        else if (!readArchivePlayer(pg->in, pg->index, (uint32_t)idx, INT32_MIN, league.players[idx].games, read, error)) {
+            league.players[idx].games = GameStore();
+            log << "Cannot load player '" << league.players[idx].name << "' from '" << pg->filename << "': " << error << ".\n\n";
+            return false;
+        }
+        BSTATS_BYTES(PROBE_PAGE_IN, read, 0);
+        pg->bytes[idx] = league.players[idx].games.memoryBytes();
+        pg->residentBytes += pg->bytes[idx];
+        pg->lru.push_front(idx);
+        pg->lruPos[idx] = pg->lru.begin();
+        st = PlayerPager::IN;
+    }
+    else if (st == PlayerPager::IN) {
+        pg->lru.splice(pg->lru.begin(), pg->lru, pg->lruPos[idx]);
+    }
+    if (st == PlayerPager::IN && use != PAGE_TOUCH) {
+        pg->lru.erase(pg->lruPos[idx]);
+        st = use == PAGE_PIN ? PlayerPager::PINNED : PlayerPager::HELD;
+    }
+    else if (st == PlayerPager::HELD && use == PAGE_PIN) {
+        st = PlayerPager::PINNED;
+    }
+    while (overBudget(*pg) && !pg->lru.empty() && pg->lru.back() != idx) evictPlayer(league, pg->lru.back());
+    return true;
+}
+
+// Undo PAGE_HOLD: player idx becomes evictable again
+void release(League& league, int idx) {
+    PlayerPager* pg = league.pager.get();
+    if (!pg || (size_t)idx >= pg->state.size() || pg->state[idx] != PlayerPager::HELD) return;
+    pg->lru.push_front(idx);
+    pg->lruPos[idx] = pg->lru.begin();
+    pg->state[idx] = PlayerPager::IN;
+    while (overBudget(*pg) && !pg->lru.empty()) evictPlayer(league, pg->lru.back());
+}
+
+// Undo PAGE_HOLD on player idx after its games were changed. A pooled
+// player is packed again (its old bytes stay in the pool until the league
+// is compacted again) and becomes evictable; an archive player can no
+// longer be read back from its blocks, so it is pinned.
+void releaseChanged(League& league, int idx) {
+    PlayerPager* pg = league.pager.get();
+    if (!pg || (size_t)idx >= pg->state.size() || pg->state[idx] != PlayerPager::HELD) return;
+    if (!pg->pooled) {
+        pg->state[idx] = PlayerPager::PINNED;
+        return;
+    }
+    poolPlayer(pg->pool, league.players[idx].games);
+    pg->pool.players[idx] = pg->pool.players.back();
+    pg->pool.players.pop_back();
+    // Appending one player must not leave the buffers at double capacity
+    pg->pool.bytes.shrink_to_fit();
+    pg->pool.escapes.shrink_to_fit();
+    pg->pool.players.shrink_to_fit();
+    release(league, idx);
+}
+
+// Page every player in and close the archive (or drop the pool), for
+// operations that need the whole league at once (saving, merging,
+// leaderboards)
+bool pageInAll(League& league, ostream& log = console) {
+    if (!league.pager) return true;
+    size_t saved = memoryBudget;
+    memoryBudget = SIZE_MAX;
+    bool ok = true;
+    for (size_t i = 0; ok && i < league.players.size(); ++i) ok = pageIn(league, (int)i, PAGE_TOUCH, log);
+    memoryBudget = saved;
+    if (ok) league.pager.reset();
+    return ok;
+}
+
+// Call fn(begin, end) for consecutive ranges of players whose games fit in
+// the memory budget together; each range is paged in and held while fn runs,
+// so reports and exports can work on it in parallel. Without a pager fn
+// gets every player at once.
+template <typename Fn>
+bool forEachResidentBatch(League& league, const vector<const Player*>& players, Fn fn, ostream& log = console) {
+    if (!league.pager) {
+        fn((size_t)0, players.size());
+        return true;
+    }
+    auto indexOf = [&](size_t k) { return (int)(players[k] - league.players.data()); };
+    // Estimated cost of a player: its columns, one int32 per stat and date
+    auto cost = [&](size_t k) { return gameCount(league, indexOf(k)) * (NUM_STATS + 1) * sizeof(int32_t); };
+    for (size_t b = 0; b < players.size();) {
+        size_t e = b + 1, total = cost(b);
+        while (e < players.size() && (memoryBudget == 0 || total + cost(e) <= memoryBudget)) total += cost(e++);
+        bool ok = true;
+        size_t held = b;
+        for (; ok && held < e; ++held) ok = pageIn(league, indexOf(held), PAGE_HOLD, log);
+        if (ok) fn(b, e);
+        for (size_t k = b; k < held; ++k) release(league, indexOf(k));
+        if (!ok) return false;
+        b = e;
+    }
+    return true;
+}
+
+// Open an archive lazily: the league gets every player's name, and games are
+// paged in on demand. Archives with repeated names are loaded eagerly, since
+// loading merges them.
+bool openArchiveLazily(League& league, const string& filename, ostream& log = console) {
+    auto pg = make_shared<PlayerPager>();
+    string error;
+    if (!readArchiveIndex(pg->in, filename, pg->index, error)) {
+        log << "Cannot load archive '" << filename << "': " << error << ".\n\n";
+        return false;
+    }
+    League opened;
+    uint32_t n = pg->index.header.playerCount;
+    opened.players.reserve(n);
+    for (uint32_t i = 0; i < n; ++i) {
+        if (opened.find(pg->index.name(i)) >= 0) return loadArchive(league, filename, log);
+        opened.add(pg->index.name(i));
+    }
+    pg->filename = filename;
+    pg->state.assign(n, PlayerPager::OUT);
+    pg->bytes.assign(n, 0);
+    pg->lruPos.resize(n);
+    league.clear();
+    league.players = move(opened.players);
+    league.byName = move(opened.byName);
+    league.pager = pg;
+    status(log) << "Opened archive with " << n << " players (" << pg->index.header.gameCount
+        << " games, loaded on demand).\n\n";
+    return true;
+}
+
+// Pack every player's games into a GamePool and free their columns
+// (compact mode). pageIn decodes a player again whenever a report, export
+// or edit needs it. Leagues that are already paged (an archive opened
+// lazily, or packed before) or shared with live readers are left alone, so
+// this is cheap to call after every command; it packs again only after an
+// operation decoded the whole league (saving, merging, leaderboards). Must
+// not run while a caller holds a Player reference (e.g. the player menu).
+void compactLeague(League& league) {
+    if (league.pager || league.live.active()) return;
+    BSTATS_PROBE(PROBE_COMPACT);
+    auto pg = make_shared<PlayerPager>();
+    size_t n = league.players.size(), games = 0;
+    for (const Player& p : league.players) games += p.games.size();
+    pg->pool.bytes.reserve(games * POOL_COLUMNS);
+    pg->pool.players.reserve(n);
+    for (Player& p : league.players) {
+        poolPlayer(pg->pool, p.games);
+        p.games = GameStore();
+        p.byDate = DateQueryIndex();
+    }
+    pg->pool.bytes.shrink_to_fit();
+    pg->pool.escapes.shrink_to_fit();
+    pg->pooled = true;
+    pg->state.assign(n, PlayerPager::OUT);
+    pg->bytes.assign(n, 0);
+    pg->lruPos.resize(n);
+    league.pager = pg;
+}
+
+// Turn live access on for readers on other threads: page everything in and
+// publish a copy of every player (see LiveStore)
+bool startLive(League& league, ostream& log = console) {
+    if (!pageInAll(league, log)) return false;
+    lock_guard<mutex> lock(league.writeLock);
+    league.live.start(league.players);
+    return true;
+}
+
+// ======================================================
+// MEMORY REPORT: what the dataset costs in memory
+// ======================================================
+
+// Resident set size of the process in bytes, 0 where it is not known
+size_t processResidentBytes() {
+#ifdef __linux__
+    ifstream in("/proc/self/statm");
+    size_t pages = 0, resident = 0;
+    if (in >> pages >> resident) return resident * (size_t)sysconf(_SC_PAGESIZE);
+#endif
+    return 0;
+}
+
+// Bytes held by the games, indexes and names of the league, split by part
+// and per player and game, then the process's resident size for comparison
+void showMemory(League& league, ostream& out = console) {
+    size_t players = league.players.size(), games = 0, decoded = 0;
+    size_t columns = 0, views = 0, indexes = 0;
+    for (size_t i = 0; i < players; ++i) {
+        const Player& p = league.players[i];
+        games += gameCount(league, (int)i);
+        decoded += p.games.size();
+        views += p.games.viewBytes();
+        columns += p.games.memoryBytes() - p.games.viewBytes();
+        indexes += p.byDate.memoryBytes();
+    }
+    const PlayerPager* pg = league.pager.get();
+    size_t packed = pg && pg->pooled ? pg->pool.games() : 0;
+    size_t pool = pg && pg->pooled ? pg->pool.memoryBytes() : 0;
+    size_t pager = pg ? pg->state.capacity() + pg->bytes.capacity() * sizeof(size_t)
+        + pg->lruPos.capacity() * sizeof(list<int>::iterator) + pg->lru.size() * (sizeof(int) + 2 * sizeof(void*)) : 0;
+    struct Part { const char* name; size_t bytes; };
+    const Part parts[] = {
+        { "Game columns", columns },
+        { "Sorted views", views },
+        { "Query indexes", indexes },
+        { "Packed games", pool },
+        { "Pager", pager },
+        { "Player records", league.players.capacity() * sizeof(Player) + league.byName.memoryBytes() },
+        { "Names", namePool.memoryBytes() },
+        { "Team dictionary", teamDict.memoryBytes() },
+    };
+    auto per = [](size_t bytes, size_t n) { return n ? (double)bytes / n : 0.0; };
+
+    out << "\n=== MEMORY ===\n\n";
+    out << "Players: " << players << "\n\n";
+    out << "Games: " << games << " (" << decoded << " decoded";
+    if (pg && pg->pooled) out << ", " << packed << " packed";
+    else if (pg) out << ", " << games - decoded << " on disk";
+    out << ")\n\n";
+    out << fixed << setprecision(2);
+    out << left << setw(18) << "Part" << right << setw(14) << "Bytes" << setw(13) << "Per player" << setw(11) << "Per game" << '\n';
+    size_t total = 0;
+    for (const Part& part : parts) {
+        out << left << setw(18) << part.name << right << setw(14) << part.bytes << setw(13) << per(part.bytes, players)
+            << setw(11) << per(part.bytes, games) << '\n';
+        total += part.bytes;
+    }
+    out << left << setw(18) << "Total" << right << setw(14) << total << setw(13) << per(total, players)
+        << setw(11) << per(total, games) << "\n\n";
+    if (decoded) out << "Decoded game: " << per(columns, decoded) << " bytes\n\n";
+    if (packed) out << "Packed game: " << per(pool, packed) << " bytes\n\n";
+    size_t rss = processResidentBytes();
+    if (rss) out << "Process resident: " << rss << " bytes\n\n";
+}
+
+// ======================================================
+// DATA FILES: any format plus its journal
+// ======================================================
+
+enum DataFormat { FORMAT_TEXT, FORMAT_SNAPSHOT, FORMAT_ARCHIVE };
+
+const char* const FORMAT_NAMES[] = { "text file", "snapshot", "archive" };
+
+// The format of an existing file, from its first bytes (text if unknown)
+DataFormat dataFormatOf(const string& filename) {
+    ifstream in(filename, ios::binary);
+    char magic[4] = {};
+    if (!in.read(magic, sizeof(magic))) return FORMAT_TEXT;
+    if (memcmp(magic, SNAPSHOT_MAGIC, sizeof(magic)) == 0) return FORMAT_SNAPSHOT;
+    if (memcmp(magic, ARCHIVE_MAGIC, sizeof(magic)) == 0) return FORMAT_ARCHIVE;
+    return FORMAT_TEXT;
+}
+
+// 64-bit FNV-1a over a whole file, 8 bytes per step; identifies the data
+// file a journal belongs to. False if the file cannot be read.
+bool hashFile(const string& filename, uint64_t& hash) {
+    ifstream in(filename, ios::binary);
+    if (!in) return false;
+    vector<char> buf(1 << 20);
+    uint64_t h = 1469598103934665603ULL;
+    while (in.read(buf.data(), buf.size()) || in.gcount() > 0) {
+        size_t n = (size_t)in.gcount(), i = 0;
+        for (; i + 8 <= n; i += 8) {
+            uint64_t w;
+            memcpy(&w, &buf[i], 8);
+            h ^= w;
+            h *= 1099511628211ULL;
+        }
+        for (; i < n; ++i) { h ^= (unsigned char)buf[i]; h *= 1099511628211ULL; }
+    }
+    hash = h;
+    return !in.bad();
+}
+
+// Journal team id -> teamDict id, as bound by the JOP_TEAM records replayed so far
+typedef vector<uint16_t> JournalTeams;
+
+// The journal found next to a data file when it was loaded
+struct JournalScan {
+    uint64_t baseHash = 0;   // hashFile() of the data file
+    bool matches = false;    // a journal exists and was written against that file
+    uint64_t validBytes = 0; // header plus every record that was replayed
+};
+
+// Apply one journal record to the league; false if it does not fit it
+// (error says why when the record itself is not at fault).
+// Game records with dimensions (version 2) map their team ids through teams.
+bool applyJournalRecord(League& league, string_view rec, JournalTeams& teams, string& error) {
+    auto u32 = [&](size_t at) { uint32_t v; memcpy(&v, rec.data() + at, sizeof(v)); return v; };
+    auto u16 = [&](size_t at) { uint16_t v; memcpy(&v, rec.data() + at, sizeof(v)); return v; };
+    const size_t GAME_BYTES = 4 + 4 * NUM_STATS, DIM_BYTES = 2 * NUM_DIMS;
+    bool ok = true;
+    auto game = [&](size_t at) {
+        GameStats g;
+        g.date = (int32_t)u32(at);
+        for (int s = 0; s < NUM_STATS; ++s) g.*STAT_FIELDS[s] = (int32_t)u32(at + 4 + 4 * s);
+        if (rec.size() == at + GAME_BYTES + DIM_BYTES) {
+            for (int k = 0; k < NUM_DIMS; ++k) {
+                uint16_t v = u16(at + GAME_BYTES + 2 * k);
+                if (k == DIM_VENUE) ok = ok && v <= VENUE_AWAY;
+                else if (v >= teams.size() || (v && !teams[v])) ok = false;
+                else v = teams[v];
+                g.*DIM_FIELDS[k] = v;
+            }
+        }
+        return g;
+        };
+    auto gameSize = [&](size_t at) { return rec.size() == at + GAME_BYTES || rec.size() == at + GAME_BYTES + DIM_BYTES; };
+    if (rec.empty()) return false;
+    if (rec[0] == JOP_TEAM) {
+        if (rec.size() < 3 || u16(1) == 0) return false;
+        if (teams.size() <= u16(1)) teams.resize(u16(1) + 1, 0);
+        if (teamDict.idOf(rec.substr(3), teams[u16(1)])) return true;
+        error = TeamDictionary::FULL_ERROR;
+        return false;
+    }
+    uint32_t player = rec.size() >= 5 ? u32(1) : 0;
+    bool known = player < league.players.size();
+    if (rec[0] != JOP_ADD_PLAYER && known && !pageIn(league, (int)player, PAGE_PIN)) return false;
+    switch (rec[0]) {
+    case JOP_ADD_PLAYER: {
+        string_view name = rec.substr(1);
+        if (name.empty() || league.find(name) >= 0) return false;
+        league.add(name);
+        return true;
+    }
+    case JOP_ADD_GAME: {
+        if (!gameSize(5) || !known) return false;
+        GameStats g = game(5);
+        if (!ok) return false;
+        league.players[player].games.push_back(g);
+        league.touch((int)player);
+        return true;
+    }
+    case JOP_EDIT_GAME: {
+        if (!gameSize(9) || !known || u32(5) >= league.players[player].games.size()) return false;
+        GameStats g = game(9);
+        if (!ok) return false;
+        league.players[player].games.set(u32(5), g);
+        league.touch((int)player);
+        return true;
+    }
+    case JOP_DELETE_GAME:
+        if (rec.size() != 9 || !known || u32(5) >= league.players[player].games.size()) return false;
+        league.players[player].games.erase(u32(5));
+        league.touch((int)player);
+        return true;
+    }
+    return false;
+}
+
+// Replay filename's journal onto league, which was just loaded from it.
+// Replay stops at a torn or inconsistent record; everything before it is kept.
+JournalScan replayJournal(League& league, const string& filename, ostream& log) {
+    BSTATS_PROBE(PROBE_JOURNAL_REPLAY);
+    JournalScan scan;
+    string path = journalFileFor(filename), data;
+    if (!readWholeFile(path, data)) return scan;
+    BSTATS_BYTES(PROBE_JOURNAL_REPLAY, data.size(), 0);
+    hashFile(filename, scan.baseHash);
+
+    JournalHeader h;
+    if (data.size() < sizeof(h)) {
+        log << "Warning: journal '" << path << "' is incomplete; ignored.\n\n";
+        return scan;
+    }
+    memcpy(&h, data.data(), sizeof(h));
+    if (memcmp(h.magic, JOURNAL_MAGIC, sizeof(h.magic)) != 0 || (h.version != 1 && h.version != JOURNAL_VERSION)) {
+        log << "Warning: '" << path << "' is not a journal; ignored.\n\n";
+        return scan;
+    }
+    if (h.baseHash != scan.baseHash) {
+        log << "Warning: journal '" << path << "' was written for another version of '" << filename << "'; ignored.\n\n";
+        return scan;
+    }
+    scan.matches = true;
+
+    size_t pos = sizeof(h), records = 0;
+    JournalTeams teams(1, 0);
+    string error;
+    while (pos < data.size()) {
+        uint32_t size, sum;
+        if (data.size() - pos < 8) break;
+        memcpy(&size, &data[pos], 4);
+        memcpy(&sum, &data[pos + 4], 4);
+        if (data.size() - pos - 8 < size || checksum32(&data[pos + 8], size) != sum) break;
+        if (!applyJournalRecord(league, string_view(&data[pos + 8], size), teams, error)) {
+            log << "Warning: journal record " << records + 1 << " does not fit '" << filename << "'"
+                << (error.empty() ? "" : " (" + error + ")") << "; it and later records are ignored.\n\n";
+            break;
+        }
+        pos += 8 + size;
+        ++records;
+    }
+    if (pos < data.size()) status(log) << "Ignored " << data.size() - pos << " trailing bytes of journal '" << path << "'.\n\n";
+    scan.validBytes = pos;
+    if (records > 0) status(log) << "Replayed " << records << " changes from journal '" << path << "'.\n\n";
+    return scan;
+}
+
+// Load any format, picking the loader from the file contents, then
+// replay the file's journal. When journal is given it receives the journal's
+// state for attachJournal.
+bool loadDataFile(League& league, const string& filename, ostream& log = console, bool merge = false,
+    JournalScan* journal = nullptr) {
+    if (merge && !pageInAll(league, log)) return false;
+    if (merge && filesystem::exists(journalFileFor(filename))) {
+        // The journal numbers players as in its own file, so replay it separately
+        League other;
+        // An archive opens lazily; decode it all before the players move over
+        if (!loadDataFile(other, filename, log) || !pageInAll(other, log)) return false;
+        status(log) << mergeLoaded(league, other.players, true) << " players from '" << filename << "'.\n\n";
+        return true;
+    }
+    DataFormat format = dataFormatOf(filename);
+    bool ok = format == FORMAT_SNAPSHOT ? loadSnapshot(league, filename, log, merge)
+        : format == FORMAT_ARCHIVE ? (merge ? loadArchive(league, filename, log, true) : openArchiveLazily(league, filename, log))
+        : loadAllPlayersFromFile(league, filename, log, merge);
+    if (!ok || merge) return ok;
+    JournalScan scan = replayJournal(league, filename, log);
+    if (journal) *journal = scan;
+    return true;
+}
+
+// Journal further interactive changes against filename, which the league
+// was just loaded from (scan from loadDataFile) or saved to. Unless scan
+// matches an existing journal, a new one is started.
+bool attachJournal(League& league, const string& filename, const JournalScan& scan = JournalScan(),
+    ostream& log = console) {
+    uint64_t hash = scan.baseHash;
+    string error;
+    if (!scan.matches && !hashFile(filename, hash)) error = "cannot read the data file";
+    else if (league.journal.open(filename, hash, scan.matches ? scan.validBytes : 0, error)) return true;
+    log << "Warning: cannot open journal '" << journalFileFor(filename) << "' (" << error
+        << "); changes are kept only until you save.\n\n";
+    return false;
+}
+
+// Write the whole league to filename in the given format. This folds
+// the file's journal into it: a journal open on the file starts over empty
+// and a stale one is removed. With journalAfter set later changes are
+// journaled against filename.
+bool saveDataFile(League& league, const string& filename, DataFormat format, ostream& log = console,
+    bool journalAfter = false) {
+    if (!pageInAll(league, log)) return false;
+    Journal& j = league.journal;
+    uint64_t oldHash = j.baseHash(), oldSize = j.size();
+    bool onFile = j.isOpen() && j.dataFile() == filename;
+    if (onFile) j.close();
+    bool ok = format == FORMAT_SNAPSHOT ? saveSnapshot(league.players, filename, log)
+        : format == FORMAT_ARCHIVE ? saveArchive(league.players, filename, log)
+        : saveAllPlayersToFile(league.players, filename, log);
+    if (!ok) {
+        // The file and its journal are untouched; keep appending to it
+        if (onFile) {
+            JournalScan scan;
+            scan.baseHash = oldHash;
+            scan.matches = true;
+            scan.validBytes = oldSize;
+            attachJournal(league, filename, scan, log);
+        }
+        return false;
+    }
+    if (onFile || journalAfter) attachJournal(league, filename, JournalScan(), log);
+    else {
+        error_code ec;
+        filesystem::remove(journalFileFor(filename), ec);
+    }
+    return true;
+}
+
+// Save the journaled data file in full, in its own format. Used for
+// compaction and after bulk changes (merge, import) that are not journaled.
+void rewriteJournaledFile(League& league, ostream& log = console) {
+    if (!league.journal.isOpen()) return;
+    string file = league.journal.dataFile();
+    saveDataFile(league, file, dataFormatOf(file), log);
+}
+
+// Fold the journal into its data file once it has grown past the data
+// file itself (and at least 64 KiB). Replay then never costs more than the
+// load, and the full rewrite happens only after that many bytes of changes.
+void maybeCompactJournal(League& league, ostream& log = console) {
+    const uint64_t MIN_COMPACT_BYTES = 64 << 10;
+    Journal& j = league.journal;
+    if (!j.isOpen() || j.size() < MIN_COMPACT_BYTES) return;
+    error_code ec;
+    uint64_t base = filesystem::file_size(j.dataFile(), ec);
+    if (!ec && j.size() < base) return;
+    status(log) << "Compacting journal into '" << j.dataFile() << "'.\n";
+    rewriteJournaledFile(league, log);
+}
+
+// Load a data file and journal later changes against it (interactive mode)
+bool openDataFile(League& league, const string& filename, ostream& log = console) {
+    JournalScan scan;
+    if (!loadDataFile(league, filename, log, false, &scan)) return false;
+    attachJournal(league, filename, scan, log);
+    return true;
+}
+
+// Load only part of an archive (a player, a season or both). The journal
+// numbers games as in the whole file, so it is not replayed here.
+bool loadArchivePart(League& league, const string& filename, const ArchiveFilter& filter, ostream& log = console) {
+    if (dataFormatOf(filename) != FORMAT_ARCHIVE) {
+        log << "'" << filename << "' is not an archive; only archives can be loaded in part.\n\n";
+        return false;
+    }
+    if (filesystem::exists(journalFileFor(filename))) {
+        log << "Warning: partial load of '" << filename << "' does not include the changes in its journal.\n\n";
+    }
+    return loadArchive(league, filename, log, false, filter);
+}
+
+// Default output format for convertDataFile: text and snapshot convert to
+// each other, an archive converts to text
+DataFormat convertTargetFor(const string& from) {
+    return dataFormatOf(from) == FORMAT_TEXT ? FORMAT_SNAPSHOT : FORMAT_TEXT;
+}
+
+// Convert a data file to another format. The input format is detected
+// from the file contents.
+bool convertDataFile(const string& from, const string& to, DataFormat format, ostream& log = console) {
+    error_code same;
+    if (filesystem::equivalent(from, to, same)) {
+        log << "Cannot convert '" << from << "' onto itself; choose another output file.\n\n";
+        return false;
+    }
+    if (dataFormatOf(from) != FORMAT_SNAPSHOT || format != FORMAT_TEXT || filesystem::exists(journalFileFor(from))) {
+        // Full load, so the input's journal is included
+        League league;
+        if (!loadDataFile(league, from, log)) return false;
+        return saveDataFile(league, to, format, log);
+    }
+    // Snapshot -> text streams straight out of the mapping
+    MappedSnapshot snap;
+    string error;
+    if (!snap.open(from, error)) {
+        log << "Cannot read snapshot '" << from << "': " << error << ".\n\n";
+        return false;
+    }
+    // Written to the temp file and renamed over to like every save, so a
+    // failure part way leaves any existing file intact
+    string tmp = tempFileFor(to);
+    ofstream out(tmp);
+    if (!out) {
+        log << "Error opening '" << to << "' for writing.\n\n";
+        return false;
+    }
+    out << snap.playerCount() << '\n';
+    for (uint32_t i = 0; i < snap.playerCount(); ++i) {
+        out << snap.playerName(i) << '\n';
+        out << snap.playerGameCount(i) << '\n';
+        const SnapshotGame* games = snap.playerGames(i);
+        const SnapshotDims* dims = snap.playerDims(i);
+        for (size_t j = 0; j < snap.playerGameCount(i); ++j) {
+            const SnapshotGame& g = games[j];
+            char date[DATE_CHARS];
+            out.write(date, formatDateTo(date, g.date) - date);
+            for (int s = 0; s < NUM_STATS; ++s) out << ' ' << g.stats[s];
+            if (dims && (dims[j].dims[DIM_TEAM] || dims[j].dims[DIM_OPPONENT] || dims[j].dims[DIM_VENUE])) {
+                const uint16_t* d = dims[j].dims;
+                if (d[DIM_TEAM] >= snap.teamCount() || d[DIM_OPPONENT] >= snap.teamCount() || d[DIM_VENUE] > VENUE_AWAY) {
+                    log << "Cannot read snapshot '" << from << "': corrupt game dimensions in player " << i + 1 << ".\n\n";
+                    out.close();
+                    remove(tmp.c_str());
+                    return false;
+                }
+                out << " | " << snap.teamName(d[DIM_TEAM]) << " | " << snap.teamName(d[DIM_OPPONENT])
+                    << " | " << VENUE_NAMES[d[DIM_VENUE]];
+            }
+            out << '\n';
+        }
+    }
+    out.close();
+    if (!out || !commitTempFile(to)) {
+        log << "Error writing '" << to << "'.\n\n";
+        remove(tmp.c_str());
+        return false;
+    }
+    error_code ec;
+    filesystem::remove(journalFileFor(to), ec); // stale now
+    status(log) << "Converted snapshot '" << from << "' to text file '" << to << "'.\n\n";
+    return true;
+}
+
+// CSV filename used for bulk exports: "<playername>.csv" with spaces replaced by underscores
+string csvFileNameFor(const Player& p) {
+    string fname(p.name);
+    replace(fname.begin(), fname.end(), ' ', '_');
+    return fname + ".csv";
+}
+
+// Games played, PPG and PER for one player
+void showQuickSummaryLine(const Player& p, ostream& out = console) {
+    BSTATS_PROBE(PROBE_QUICK_REPORT);
+    out << p.name << " - Games: " << p.games.size() << '\n';
+    if (!p.games.empty()) {
+        out << ", PPG: " << fixed << setprecision(2)
+            << (double)p.games.totals().sum[STAT_POINTS] / p.games.size();
+        out << ", PER: " << simplePER(p) << '\n';
+    }
+    out << "\n\n";
+}
+
+// ======================================================
+// PARALLEL LEAGUE-WIDE REPORTS: summaries and CSV export on all cores
 // ======================================================
 
-// Holds stats for a single game
-struct GameStats {
-    string date;    // YYYY-MM-DD (use this format so lexical sort by date works)
-    int points;
-    int rebounds;
-    int assists;
-    int steals;
-    int blocks;
+// Worker threads for league-wide operations (--threads); 0 = one per core
+unsigned reportThreads = 0;
 
-    int fgm, fga;   // Field Goals Made/Attempted
-    int threem, threea; // 3-point Made/Attempted
-    int ftm, fta;   // Free Throws Made/Attempted
+unsigned workerCount() {
+    if (reportThreads > 0) return reportThreads;
+    unsigned hw = thread::hardware_concurrency();
+    return hw > 0 ? hw : 1;
+}
 
-    // A simple constructor for convenience
-    GameStats() : date(""), points(0), rebounds(0), assists(0), steals(0), blocks(0),
-        fgm(0), fga(0), threem(0), threea(0), ftm(0), fta(0) {
+// Run fn(i) for every i in [0, n). Workers claim small chunks from a shared
+// atomic cursor, so a thread that finishes its chunk simply takes the next
+// one and uneven players (1 game vs. 1,500) balance out. Small jobs and
+// single-thread settings run inline.
+template <typename Fn>
+void parallelFor(size_t n, Fn fn) {
+    const size_t CHUNK = 16;
+    unsigned threads = (unsigned)min<size_t>(workerCount(), (n + CHUNK - 1) / CHUNK);
+    if (threads <= 1) {
+        for (size_t i = 0; i < n; ++i) fn(i);
+        return;
     }
-};
+    atomic<size_t> next(0);
+    auto work = [&]() {
+        for (size_t b; (b = next.fetch_add(CHUNK)) < n;) {
+            for (size_t i = b, e = min(n, b + CHUNK); i < e; ++i) fn(i);
+        }
+        };
+    vector<thread> pool;
+    for (unsigned t = 1; t < threads; ++t) pool.emplace_back(work);
+    work();
+    for (auto& t : pool) t.join();
+}
 
-// Holds a player's name and all their games
-struct Player {
-    string name;
-    vector<GameStats> games;
-};
+// Call render(i, os) for every i in [0, n) in parallel, each into its own
+// buffer, then write the buffers to out in index order so the output is the
+// same as a serial run. Work is done in batches to bound buffer memory.
+template <typename Fn>
+void renderInOrder(size_t n, ostream& out, Fn render) {
+    const size_t BATCH = 4096;
+    vector<string> parts;
+    for (size_t base = 0; base < n; base += BATCH) {
+        size_t count = min(BATCH, n - base);
+        parts.assign(count, string());
+        parallelFor(count, [&](size_t k) {
+            ostringstream os;
+            render(base + k, os);
+            parts[k] = os.str();
+            });
+        for (const auto& part : parts) out.write(part.data(), part.size());
+    }
+}
+
+// Pointers to every player, for functions that work on a selection
+vector<const Player*> allPlayers(const vector<Player>& players) {
+    vector<const Player*> refs;
+    refs.reserve(players.size());
+    for (const auto& p : players) refs.push_back(&p);
+    return refs;
+}
+
+// Summary line for every player. The report is kept in league.cache: asking
+// again with no change in between is a single write, and after a change
+// only the players whose version moved are rendered (and paged in) again.
+void showQuickSummary(League& league, ostream& out = console) {
+    CachedReport<string>& c = league.cache.text["quick_summary"];
+    if (c.version != league.version) {
+        vector<const Player*> stale;
+        for (size_t i : c.stale(league.players)) stale.push_back(&league.players[i]);
+        bool paged = forEachResidentBatch(league, stale, [&](size_t b, size_t e) {
+            parallelFor(e - b, [&](size_t i) {
+                const Player& p = *stale[b + i];
+                ostringstream os;
+                showQuickSummaryLine(p, os);
+                c.parts[&p - league.players.data()] = os.str();
+                });
+            });
+        c.result = "\n=== Quick Player Summary ===\n\n";
+        for (const auto& part : c.parts) c.result += part;
+        if (!paged) {
+            out << c.result;
+            league.cache.text.erase("quick_summary");
+            return;
+        }
+        c.version = league.version;
+    }
+    out << c.result;
+}
+
+// Export each player to dir/<playername>.csv concurrently. Status lines are
+// written to log in player order. Returns false if any export failed.
+bool exportPlayersToCSV(League& league, const vector<const Player*>& players, const string& dir, ostream& log = console) {
+    atomic<bool> ok(true);
+    bool paged = forEachResidentBatch(league, players, [&](size_t b, size_t e) {
+        renderInOrder(e - b, log, [&](size_t i, ostream& os) {
+            const Player& p = *players[b + i];
+            string path = csvFileNameFor(p);
+            if (!dir.empty()) path = (filesystem::path(dir) / path).string();
+            if (!exportPlayerToCSV(p, path, os)) ok = false;
+            });
+        }, log);
+    return ok && paged;
+}
+
+// A CSV field, quoted if it holds a comma, quote or line break
+string csvField(string_view text) {
+    string field(2 * text.size() + 2, '\0');
+    field.resize(writeCsvField(&field[0], text) - field.data());
+    return field;
+}
+
+// Export the players to one CSV file with a leading Player column. Players
+// are formatted in parallel in batches; each player's rows are one block
+// that is written in player order.
+bool exportLeagueCSV(League& league, const vector<const Player*>& players, const string& filename, ostream& log = console) {
+    BSTATS_PROBE(PROBE_EXPORT_LEAGUE_CSV);
+    ofstream out(filename);
+    if (!out) {
+        log << "Error opening '" << filename << "' for CSV export.\n\n";
+        return false;
+    }
+    out << "Player," << CSV_HEADER;
+    const size_t BATCH = 1024;
+    vector<string> parts;
+    size_t games = 0;
+    bool paged = forEachResidentBatch(league, players, [&](size_t first, size_t last) {
+        for (size_t base = first; base < last; base += BATCH) {
+            size_t count = min(BATCH, last - base);
+            parts.resize(count);
+            parallelFor(count, [&](size_t k) {
+                const Player& p = *players[base + k];
+                parts[k].clear();
+                appendCsvRows(parts[k], p, csvField(p.name) + ',');
+                });
+            for (size_t k = 0; k < count; ++k) {
+                out.write(parts[k].data(), parts[k].size());
+                BSTATS_BYTES(PROBE_EXPORT_LEAGUE_CSV, 0, parts[k].size());
+                games += players[base + k]->games.size();
+            }
+        }
+        }, log);
+    out.close();
+    if (!paged) return false;
+    if (!out) {
+        log << "Error writing CSV file '" << filename << "'.\n\n";
+        return false;
+    }
+    status(log) << "Exported " << players.size() << " players (" << games << " games) to CSV file '" << filename << "'.\n\n";
+    return true;
+}
 
 // ======================================================
-// HELPER I/O UTILITIES
+// CSV IMPORT: streaming, chunked parallel parser
 // ======================================================
 
-// Read an entire line after using >> for ints; used to sync newline
-void clearInputLine() {
-    string dummy;
-    getline(cin, dummy);
+// Split the next field, quoted as by csvField or not, off the front of rest
+// into out; false if a quoted field is not properly closed
+bool nextCsvField(string_view& rest, string& out) {
+    out.clear();
+    if (!rest.empty() && rest[0] == '"') {
+        size_t i = 1;
+        for (; i < rest.size(); ++i) {
+            if (rest[i] != '"') { out += rest[i]; continue; }
+            if (i + 1 < rest.size() && rest[i + 1] == '"') { out += '"'; ++i; continue; }
+            break;
+        }
+        if (i >= rest.size() || (i + 1 < rest.size() && rest[i + 1] != ',')) return false;
+        rest.remove_prefix(i + 1);
+    }
+    else {
+        size_t comma = rest.find(',');
+        if (comma == string_view::npos) comma = rest.size();
+        out.assign(rest.substr(0, comma));
+        rest.remove_prefix(comma);
+    }
+    if (!rest.empty()) rest.remove_prefix(1);
+    return true;
 }
 
-// Read an integer safely with prompt
-int readInt(const string& prompt) {
-    int x;
-    while (true) {
-        cout << prompt;
-        if (cin >> x) {
-            clearInputLine();
-            return x;
+// Parse one CSV row "date,points,...,fta[,FG%,3P%,FT%[,team,opponent,venue]]"
+// as written by exportPlayerToCSV. The derived percentage columns are
+// skipped unparsed; missing dimension columns leave their ids 0.
+bool parseCsvRow(string_view line, int32_t& date, int32_t* stats, uint16_t* dims, string& error) {
+    const char* p = line.data();
+    const char* end = p + line.size();
+    const char* comma = (const char*)memchr(p, ',', end - p);
+    if (!comma) { error = "expected at least " + to_string(NUM_STATS + 1) + " comma-separated fields"; return false; }
+    if (!parseDate(string_view(p, comma - p), date)) {
+        error = "invalid date '" + string(p, comma) + "' (expected YYYY-MM-DD)";
+        return false;
+    }
+    p = comma + 1;
+    for (int s = 0; s < NUM_STATS; ++s) {
+        auto r = from_chars(p, end, stats[s]);
+        bool last = s == NUM_STATS - 1;
+        if (r.ec != errc() || (r.ptr != end && *r.ptr != ',') || (!last && r.ptr == end)) {
+            const char* stop = (const char*)memchr(p, ',', end - p);
+            if (!last && r.ec == errc() && r.ptr == end) error = string("missing ") + STAT_NAMES[s + 1] + " (expected " + to_string(NUM_STATS + 1) + " fields)";
+            else error = string("invalid ") + STAT_NAMES[s] + " '" + string(p, stop ? stop : end) + "'";
+            return false;
         }
-        else {
-            cout << "Invalid integer. Try again.\n"<<endl;
-            cin.clear();
-            clearInputLine();
+        p = r.ptr + (r.ptr != end);
+    }
+    for (int k = 0; k < NUM_DIMS; ++k) dims[k] = 0;
+    string_view rest(p, end - p);
+    for (int f = 0; f < NUM_SHOTS && !rest.empty(); ++f) {
+        size_t comma = rest.find(',');
+        rest = comma == string_view::npos ? string_view() : rest.substr(comma + 1);
+    }
+    if (rest.empty()) return true;
+    thread_local string field;
+    for (int k = 0; k < NUM_DIMS; ++k) {
+        if (!nextCsvField(rest, field)) { error = string("invalid ") + DIM_NAMES[k] + " field"; return false; }
+        string_view v = trimmed(field);
+        if (k == DIM_VENUE) {
+            if (!parseVenue(v, dims[k])) { error = "invalid venue '" + string(v) + "' (expected home, away or nothing)"; return false; }
+        }
+        else if (v.find('|') != string_view::npos) {
+            error = string(DIM_NAMES[k]) + " names may not contain '|'";
+            return false;
+        }
+        else if (!teamDict.idOf(v, dims[k])) {
+            error = TeamDictionary::FULL_ERROR;
+            return false;
         }
     }
+    return true;
 }
 
-// Read a string line (including spaces)
-string readLine(const string& prompt) {
-    cout << prompt;
-    string s;
-    getline(cin, s);
-    return s;
+// Games parsed from one slice of a chunk: rows of date, NUM_STATS values
+// and NUM_DIMS dimension ids
+struct CsvSlice {
+    const char* begin;
+    const char* end;
+    vector<int32_t> rows;
+    size_t lines = 0;     // lines in the slice
+    size_t errorLine = 0; // 1-based line of the first bad row, 0 if none
+    string error;
+};
+
+const size_t CSV_ROW = 1 + NUM_STATS + NUM_DIMS;
+
+void parseCsvSlice(CsvSlice& slice) {
+    TextCursor cur(slice.begin, slice.end);
+    string_view line;
+    int32_t row[CSV_ROW];
+    uint16_t dims[NUM_DIMS];
+    while (cur.nextLine(line)) {
+        if (line.empty()) continue;
+        if (!parseCsvRow(line, row[0], row + 1, dims, slice.error)) { slice.errorLine = cur.line; return; }
+        for (int k = 0; k < NUM_DIMS; ++k) row[1 + NUM_STATS + k] = dims[k];
+        slice.rows.insert(slice.rows.end(), row, row + CSV_ROW);
+    }
+    slice.lines = cur.line;
+}
+
+// Import a CSV written by exportPlayerToCSV and add its games to the player
+// with this name (created if missing). The file is streamed in fixed-size
+// chunks, so memory use is one chunk plus the games themselves. Each chunk
+// is cut at line boundaries into slices that are parsed in parallel and
+// appended in file order; the store is reserved from the file size after the
+// first chunk. A bad row aborts the import with its line number and leaves
+// the league unchanged.
+bool importPlayerCSV(League& league, const string& filename, string_view name, ostream& log = console) {
+    BSTATS_PROBE(PROBE_IMPORT_CSV);
+    const size_t CHUNK = 16 << 20;
+    ifstream in(filename, ios::binary);
+    if (!in) {
+        log << "Error opening '" << filename << "' for CSV import.\n\n";
+        return false;
+    }
+    error_code ec;
+    uintmax_t fileSize = filesystem::file_size(filename, ec);
+
+    Player staged(name);
+    vector<CsvSlice> slices(16 * workerCount());
+    string buf;
+    size_t carry = 0;       // bytes of an unfinished line kept from the last chunk
+    size_t lineBase = 0;    // lines before the current chunk
+    uintmax_t consumed = 0; // bytes parsed so far
+    bool header = true, reserved = false;
+
+    for (bool eof = false; !eof;) {
+        buf.resize(carry + CHUNK);
+        in.read(&buf[carry], CHUNK);
+        size_t got = carry + (size_t)in.gcount();
+        eof = !in;
+        if (in.bad()) break;
+        const char* begin = buf.data();
+        const char* end = begin + got;
+        if (!eof) {
+            // Parse complete lines only; the tail is carried into the next chunk
+            const char* p = end;
+            while (p > begin && p[-1] != '\n') --p;
+            if (p == begin) { carry = got; continue; } // a line longer than a chunk
+            end = p;
+        }
+        if (header) {
+            TextCursor cur(begin, end);
+            string_view line;
+            cur.nextLine(line);
+            if (line.compare(0, 5, "Date,") != 0) {
+                log << "Error: " << filename << " line 1: expected the 'Date,Points,...' header.\n\n";
+                return false;
+            }
+            begin = cur.pos;
+            lineBase = 1;
+            header = false;
+        }
+
+        // Cut the chunk into slices that end on line boundaries
+        size_t n = slices.size(), step = (end - begin) / n + 1;
+        const char* p = begin;
+        for (auto& s : slices) {
+            s.begin = p;
+            if (p < end) {
+                p = min(end, p + step);
+                while (p < end && p[-1] != '\n') ++p;
+            }
+            s.end = p;
+            s.rows.clear();
+            s.lines = s.errorLine = 0;
+        }
+        parallelFor(n, [&](size_t i) { parseCsvSlice(slices[i]); });
+
+        size_t rows = 0;
+        for (auto& s : slices) {
+            if (s.errorLine) {
+                log << "Error: " << filename << " line " << lineBase + s.errorLine << ": " << s.error << ".\n\n";
+                return false;
+            }
+            lineBase += s.lines;
+            rows += s.rows.size() / CSV_ROW;
+        }
+        consumed += end - buf.data();
+        if (!reserved && rows > 0) {
+            // Estimate the total from this chunk's bytes per row
+            staged.games.reserve((size_t)(rows * max<double>(1.0, (double)fileSize / consumed) * 1.02));
+            reserved = true;
+        }
+        for (auto& s : slices) {
+            uint16_t dims[NUM_DIMS];
+            for (size_t r = 0; r < s.rows.size(); r += CSV_ROW) {
+                for (int k = 0; k < NUM_DIMS; ++k) dims[k] = (uint16_t)s.rows[r + 1 + NUM_STATS + k];
+                staged.games.appendUntracked(s.rows[r], &s.rows[r + 1], dims);
+            }
+        }
+
+        carry = got - (end - buf.data());
+        memmove(&buf[0], end, carry);
+    }
+    if (in.bad()) {
+        log << "Error reading '" << filename << "'.\n\n";
+        return false;
+    }
+    if (header) {
+        log << "Error: " << filename << " line 1: expected the 'Date,Points,...' header.\n\n";
+        return false;
+    }
+    BSTATS_BYTES(PROBE_IMPORT_CSV, consumed, 0);
+    staged.games.retotal();
+    size_t games = staged.games.size();
+    int existing = league.find(name);
+    if (existing >= 0 && !pageIn(league, existing, PAGE_PIN, log)) return false;
+    league.merge(move(staged));
+    status(log) << "Imported " << games << " games for " << name << " from '" << filename << "'.\n\n";
+    return true;
+}
+
+// Player name for an imported CSV: the file's stem with underscores as
+// spaces, the reverse of csvFileNameFor
+string playerNameForCSV(const string& filename) {
+    string name = filesystem::path(filename).stem().string();
+    replace(name.begin(), name.end(), '_', ' ');
+    return name;
 }
 
 // ======================================================
-// CALCULATION HELPERS
+// GROUP-BY REPORTS: league totals split by player, team, opponent, season, venue
 // ======================================================
 
-// Field goal % (returns double, 0 if attempts = 0)
-double pct(int made, int att) {
-    if (att == 0) return 0.0;
-    return (double)made / att * 100.0;
+enum GroupKey { GROUP_PLAYER, GROUP_TEAM, GROUP_OPPONENT, GROUP_SEASON, GROUP_VENUE, NUM_GROUP_KEYS };
+const char* const GROUP_KEY_NAMES[NUM_GROUP_KEYS] = { "player", "team", "opponent", "season", "venue" };
+
+// Parse a comma-separated list of GROUP_KEY_NAMES, in output column order
+bool parseGroupKeys(const string& list, vector<GroupKey>& keys) {
+    keys.clear();
+    size_t start = 0;
+    for (;;) {
+        size_t comma = list.find(',', start);
+        string_view name = string_view(list).substr(start, comma == string::npos ? string::npos : comma - start);
+        int k = 0;
+        while (k < NUM_GROUP_KEYS && name != GROUP_KEY_NAMES[k]) ++k;
+        if (k == NUM_GROUP_KEYS || find(keys.begin(), keys.end(), (GroupKey)k) != keys.end()) return false;
+        keys.push_back((GroupKey)k);
+        if (comma == string::npos) return true;
+        start = comma + 1;
+    }
 }
 
-// Simple classroom-style Player Efficiency Rating (PER)
-// This is NOT the NBA's PER; it's a simplified, transparent formula useful for learning.
-// Example formula used here:
-//   raw = points + rebounds + assists + steals + blocks
-//         - ( (fga - fgm) + (fta - ftm) )   // punishment for missed shots
-// Then normalized by games (if passed gamesCount) to get per-game value.
-double simplePER(const Player& p) {
-    if (p.games.empty()) return 0.0;
-    double totalRaw = 0.0;
-    for (const auto& g : p.games) {
-        double raw = g.points + g.rebounds + g.assists + g.steals + g.blocks;
-        raw -= ((g.fga - g.fgm) + (g.fta - g.ftm)); // penalty for misses
-        totalRaw += raw;
+// A group's key packs the team, opponent, season and venue into 16 bits
+// each (0 for keys not grouped on); the player is kept next to it. Seasons
+// are int16 years, enough for four-digit dates.
+const int GROUP_SHIFT[NUM_GROUP_KEYS] = { 0, 0, 16, 32, 48 };
+
+int32_t groupSeason(uint64_t key) { return (int16_t)(uint16_t)(key >> GROUP_SHIFT[GROUP_SEASON]); }
+uint16_t groupField(uint64_t key, GroupKey k) { return (uint16_t)(key >> GROUP_SHIFT[k]); }
+
+struct GroupRow {
+    int player = -1;        // -1 unless grouping by player
+    uint64_t key = 0;
+    size_t games = 0;
+    StatTotals totals;
+};
+
+// Add each of p's games to the group of its key in groups, one column at a time
+void accumulateGroups(const Player& p, const bool* by, unordered_map<uint64_t, GroupRow>& groups) {
+    size_t n = p.games.size();
+    vector<GroupRow*> slot(n);
+    const int32_t* dates = p.games.dateColumn();
+    const uint16_t* team = p.games.dimColumn(DIM_TEAM);
+    const uint16_t* opponent = p.games.dimColumn(DIM_OPPONENT);
+    const uint16_t* venue = p.games.dimColumn(DIM_VENUE);
+    int32_t season = 0, seasonStart = 1, seasonEnd = 0; // empty range: first game computes it
+    uint64_t last = 0;
+    GroupRow* row = nullptr;
+    for (size_t i = 0; i < n; ++i) {
+        uint64_t key = 0;
+        if (by[GROUP_TEAM]) key |= (uint64_t)team[i] << GROUP_SHIFT[GROUP_TEAM];
+        if (by[GROUP_OPPONENT]) key |= (uint64_t)opponent[i] << GROUP_SHIFT[GROUP_OPPONENT];
+        if (by[GROUP_VENUE]) key |= (uint64_t)venue[i] << GROUP_SHIFT[GROUP_VENUE];
+        if (by[GROUP_SEASON]) {
+            if (dates[i] < seasonStart || dates[i] >= seasonEnd) {
+                season = seasonOf(dates[i]);
+                seasonStart = daysFromCivil(season, 8, 1);
+                seasonEnd = daysFromCivil(season + 1, 8, 1);
+            }
+            key |= (uint64_t)(uint16_t)season << GROUP_SHIFT[GROUP_SEASON];
+        }
+        // Runs of games usually share a key, so only look it up when it changes
+        if (!row || key != last) {
+            row = &groups[key]; // references into an unordered_map survive rehashing
+            row->key = last = key;
+        }
+        ++row->games;
+        slot[i] = row;
+    }
+    for (int s = 0; s < NUM_STATS; ++s) {
+        const int32_t* col = p.games.column((StatId)s);
+        for (size_t i = 0; i < n; ++i) slot[i]->totals.sum[s] += col[i];
+    }
+}
+
+// Group the games of players by keys in one scan, one player per task. With
+// the player key each player's groups are its own; otherwise the players'
+// groups are merged. Rows come back sorted by their labels.
+bool groupGames(League& league, const vector<const Player*>& players, const vector<GroupKey>& keys,
+    vector<GroupRow>& rows, ostream& log = console) {
+    BSTATS_PROBE(PROBE_GROUP_BY);
+    bool by[NUM_GROUP_KEYS] = {};
+    for (GroupKey k : keys) by[k] = true;
+    rows.clear();
+    unordered_map<uint64_t, GroupRow> merged;
+    vector<vector<GroupRow>> parts;
+    bool paged = forEachResidentBatch(league, players, [&](size_t b, size_t e) {
+        parts.assign(e - b, vector<GroupRow>());
+        parallelFor(e - b, [&](size_t i) {
+            const Player& p = *players[b + i];
+            unordered_map<uint64_t, GroupRow> groups;
+            accumulateGroups(p, by, groups);
+            for (auto& g : groups) {
+                if (by[GROUP_PLAYER]) g.second.player = (int)(&p - league.players.data());
+                parts[i].push_back(g.second);
+            }
+            });
+        for (auto& part : parts) {
+            for (GroupRow& g : part) {
+                if (by[GROUP_PLAYER]) { rows.push_back(g); continue; }
+                GroupRow& m = merged[g.key];
+                m.key = g.key;
+                m.games += g.games;
+                for (int s = 0; s < NUM_STATS; ++s) m.totals.sum[s] += g.totals.sum[s];
+            }
+        }
+        }, log);
+    if (!paged) return false;
+    for (auto& m : merged) rows.push_back(m.second);
+
+    // Labels compare by name for players and teams, by value for seasons and venues
+    auto less = [&](const GroupRow& a, const GroupRow& b) {
+        for (GroupKey k : keys) {
+            int c = 0;
+            if (k == GROUP_PLAYER) c = league.players[a.player].name.compare(league.players[b.player].name);
+            else if (k == GROUP_SEASON) c = groupSeason(a.key) < groupSeason(b.key) ? -1 : groupSeason(a.key) > groupSeason(b.key);
+            else if (k == GROUP_VENUE) c = (int)groupField(a.key, k) - (int)groupField(b.key, k);
+            else c = teamDict.name(groupField(a.key, k)).compare(teamDict.name(groupField(b.key, k)));
+            if (c != 0) return c < 0;
+        }
+        return false;
+        };
+    sort(rows.begin(), rows.end(), less);
+    return true;
+}
+
+// Label of row's value for key k, as shown in the group-by table
+string groupLabel(const League& league, const GroupRow& row, GroupKey k) {
+    switch (k) {
+    case GROUP_PLAYER: return string(league.players[row.player].name);
+    case GROUP_TEAM: return dimLabel(DIM_TEAM, groupField(row.key, k));
+    case GROUP_OPPONENT: return dimLabel(DIM_OPPONENT, groupField(row.key, k));
+    case GROUP_VENUE: return dimLabel(DIM_VENUE, groupField(row.key, k));
+    case GROUP_SEASON: return formatSeason(groupSeason(row.key));
+    default: return "";
+    }
+}
+
+// Print one line per group: its labels, games, per-game averages and shooting
+void showGroups(const League& league, const vector<GroupKey>& keys, const vector<GroupRow>& rows, ostream& out = console) {
+    out << "\n=== Games by";
+    for (size_t k = 0; k < keys.size(); ++k) out << (k ? ", " : " ") << GROUP_KEY_NAMES[keys[k]];
+    out << " ===\n\n";
+    if (rows.empty()) { out << "No games to report.\n\n"; return; }
+    const int WIDTH[NUM_GROUP_KEYS] = { 22, 18, 18, 9, 6 };
+    const char* const HEADING[NUM_GROUP_KEYS] = { "Player", "Team", "Opponent", "Season", "Venue" };
+    // Averages shown per group, kept to three so the table fits 80 columns
+    const StatId AVERAGED[] = { STAT_POINTS, STAT_REBOUNDS, STAT_ASSISTS };
+    out << left;
+    for (GroupKey k : keys) out << setw(WIDTH[k]) << HEADING[k];
+    out << right << setw(6) << "GP";
+    for (StatId s : AVERAGED) out << setw(8) << STAT_DEFS[s].perGame;
+    for (const ShotDef& d : SHOT_DEFS) out << setw(8) << d.name;
+    out << '\n';
+    out << fixed << setprecision(2);
+    for (const GroupRow& r : rows) {
+        out << left;
+        for (GroupKey k : keys) out << setw(WIDTH[k]) << groupLabel(league, r, k);
+        const long long* t = r.totals.sum;
+        double g = (double)r.games;
+        out << right << setw(6) << r.games;
+        for (StatId s : AVERAGED) out << setw(8) << t[s] / g;
+        for (const ShotDef& d : SHOT_DEFS) out << setw(8) << pct(t[d.made], t[d.attempted]);
+        out << '\n';
     }
-    return totalRaw / (double)p.games.size();
+    out << '\n';
+}
+
+// Group every player's games (or just player's, if given) and print the table
+bool runGroupBy(League& league, const vector<GroupKey>& keys, const string& player, ostream& out, ostream& log) {
+    vector<const Player*> selected;
+    if (player.empty()) {
+        selected = allPlayers(league.players);
+    }
+    else {
+        int idx = league.find(player);
+        if (idx < 0) {
+            log << "No player named '" << player << "'.\n";
+            return false;
+        }
+        selected.push_back(&league.players[idx]);
+    }
+    vector<GroupRow> rows;
+    if (!groupGames(league, selected, keys, rows, log)) return false;
+    showGroups(league, keys, rows, out);
+    out.flush();
+    return true;
+}
+
+// Interactive group-by: ask for the keys and show every player's games
+void groupByMenu(League& league) {
+    string list = readLine("Group by (comma-separated: player, team, opponent, season, venue; default team,season): ");
+    if (list.empty()) list = "team,season";
+    vector<GroupKey> keys;
+    if (!parseGroupKeys(list, keys)) { console << "Unknown or repeated key in '" << list << "'.\n\n"; return; }
+    runGroupBy(league, keys, "", console, console);
 }
 
 // ======================================================
-// PLAYER & GAME OPERATIONS
+// BATCH INGESTION: feed rows validated a whole batch at a time
 // ======================================================
 
-// Add a new player and return its index in players vector
-int addPlayer(vector<Player>& players) {
-    string name = readLine("Enter new player's full name: ");
-    if (name.empty()) {
-        cout << "Player name cannot be empty.\n"<<endl;
-        return -1;
+// Box-score rules every ingested row must satisfy: every stat in
+// [0, STAT_LIMIT), each STAT_RULES pair (FGM <= FGA, 3PM <= 3PA, FTM <= FTA,
+// 3PM <= FGM) and points = the sum of each stat times its pointValue
+// (2*FGM + 3PM + FTM). Both tables are constexpr and the kernels unroll
+// their loops over them, so each rule folds into one compare.
+// The limit is far above any real box score and keeps the points sum from
+// overflowing in 32-bit lanes.
+const int32_t STAT_LIMIT = 1 << 20;
+
+// Each kernel sets bit i of rejected (one bit per row, 64 rows per word,
+// zeroed by the caller) for every row i in [0, n) that breaks a rule
+typedef void (*ValidateKernel)(const int32_t* const* cols, size_t n, uint64_t* rejected);
+
+inline bool rowBroken(const int32_t* const* c, size_t i) {
+    int32_t any = 0;
+    for (int s = 0; s < NUM_STATS; ++s) any |= c[s][i];
+    bool bad = any & ~(STAT_LIMIT - 1);
+    BSTATS_UNROLL
+    for (const StatRule& r : STAT_RULES) bad |= c[r.first][i] > c[r.second][i];
+    int32_t made = 0;
+    BSTATS_UNROLL
+    for (int s = 0; s < NUM_STATS; ++s) made += STAT_DEFS[s].pointValue * c[s][i];
+    return bad | (c[STAT_POINTS][i] != made);
+}
+
+void validateKernelScalar(const int32_t* const* cols, size_t n, uint64_t* rejected) {
+    for (size_t i = 0; i < n; ++i) rejected[i >> 6] |= (uint64_t)rowBroken(cols, i) << (i & 63);
+}
+
+#ifdef BSTATS_HAVE_AVX2
+// 8 rows per step: every rule is one compare over 8 lanes, the lane masks
+// are OR-ed together and movemask packs them into 8 bitmap bits
+__attribute__((target("avx2")))
+void validateKernelAVX2(const int32_t* const* c, size_t n, uint64_t* rejected) {
+    const __m256i high = _mm256_set1_epi32(~(STAT_LIMIT - 1));
+    const __m256i zero = _mm256_setzero_si256();
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        __m256i v[NUM_STATS];
+        __m256i any = zero;
+        for (int s = 0; s < NUM_STATS; ++s) {
+            v[s] = _mm256_loadu_si256((const __m256i*)(c[s] + i));
+            any = _mm256_or_si256(any, v[s]);
+        }
+        __m256i inRange = _mm256_cmpeq_epi32(_mm256_and_si256(any, high), zero);
+        __m256i made = zero;
+        BSTATS_UNROLL
+        for (int s = 0; s < NUM_STATS; ++s) {
+            int w = STAT_DEFS[s].pointValue;
+            if (w == 1) made = _mm256_add_epi32(made, v[s]);
+            else if (w == 2) made = _mm256_add_epi32(made, _mm256_add_epi32(v[s], v[s]));
+            else if (w != 0) made = _mm256_add_epi32(made, _mm256_mullo_epi32(v[s], _mm256_set1_epi32(w)));
+        }
+        __m256i ok = _mm256_and_si256(inRange, _mm256_cmpeq_epi32(v[STAT_POINTS], made));
+        __m256i bad = _mm256_andnot_si256(ok, _mm256_set1_epi32(-1));
+        BSTATS_UNROLL
+        for (const StatRule& r : STAT_RULES) bad = _mm256_or_si256(bad, _mm256_cmpgt_epi32(v[r.first], v[r.second]));
+        uint64_t bits = (uint32_t)_mm256_movemask_ps(_mm256_castsi256_ps(bad));
+        rejected[i >> 6] |= bits << (i & 63);
     }
-    // Check for duplicate names - optional
-    for (size_t i = 0; i < players.size(); ++i) {
-        if (players[i].name == name) {
-            cout << "Player already exists at index " << i + 1 << ".\n"<<endl;
-            return (int)i;
+    for (; i < n; ++i) rejected[i >> 6] |= (uint64_t)rowBroken(c, i) << (i & 63);
+}
+#endif
+
+#ifdef BSTATS_HAVE_NEON
+// 4 rows per step; lane masks are reduced to 4 bitmap bits by weighting
+// each lane with its bit and adding across the vector
+void validateKernelNEON(const int32_t* const* c, size_t n, uint64_t* rejected) {
+    const int32x4_t high = vdupq_n_s32(~(STAT_LIMIT - 1));
+    const uint32_t weightBits[4] = { 1, 2, 4, 8 };
+    const uint32x4_t weights = vld1q_u32(weightBits);
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        int32x4_t v[NUM_STATS];
+        int32x4_t any = vdupq_n_s32(0);
+        for (int s = 0; s < NUM_STATS; ++s) {
+            v[s] = vld1q_s32(c[s] + i);
+            any = vorrq_s32(any, v[s]);
         }
+        int32x4_t made = vdupq_n_s32(0);
+        BSTATS_UNROLL
+        for (int s = 0; s < NUM_STATS; ++s) {
+            if (STAT_DEFS[s].pointValue) made = vmlaq_n_s32(made, v[s], STAT_DEFS[s].pointValue);
+        }
+        uint32x4_t bad = vtstq_s32(any, high);
+        bad = vorrq_u32(bad, vmvnq_u32(vceqq_s32(v[STAT_POINTS], made)));
+        BSTATS_UNROLL
+        for (const StatRule& r : STAT_RULES) bad = vorrq_u32(bad, vcgtq_s32(v[r.first], v[r.second]));
+        uint64_t bits = vaddvq_u32(vandq_u32(bad, weights));
+        rejected[i >> 6] |= bits << (i & 63);
     }
+    for (; i < n; ++i) rejected[i >> 6] |= (uint64_t)rowBroken(c, i) << (i & 63);
+}
+#endif
+
+struct ValidateKernelChoice {
+    ValidateKernel fn;
+    const char* name;
+};
 
-    Player p;
-    p.name = name;
-    players.push_back(p);
-    cout << "Player '" << name << "' added (index " << players.size() << ").\n"<<endl;
-    return (int)players.size() - 1;
+ValidateKernelChoice selectValidateKernel() {
+#ifdef BSTATS_HAVE_AVX2
+    if (__builtin_cpu_supports("avx2")) return { validateKernelAVX2, "avx2" };
+#endif
+#ifdef BSTATS_HAVE_NEON
+    return { validateKernelNEON, "neon" };
+#endif
+    return { validateKernelScalar, "scalar" };
 }
 
-// Select a player by showing a menu, returns index or -1 if none
-int selectPlayer(const vector<Player>& players) {
-    if (players.empty()) {
-        cout << "No players available. Add a player first.\n"<<endl;
-        return -1;
+const ValidateKernelChoice VALIDATE_KERNEL = selectValidateKernel();
+
+// Outcome of ingestBatch: bit i of rejected is set if row i was not added
+struct BatchResult {
+    vector<uint64_t> rejected;
+    size_t accepted = 0;
+
+    bool isRejected(size_t i) const { return (rejected[i >> 6] >> (i & 63)) & 1; }
+};
+
+// Validate every row of batch against the box-score rules in one kernel
+// pass and append the rows that pass (see League::addGames). Rows naming
+// a player outside league.players are rejected too. Nothing is printed;
+// callers report rejected rows from the bitmap.
+BatchResult ingestBatch(League& league, const GameBatch& batch) {
+    BSTATS_PROBE(PROBE_INGEST_BATCH);
+    size_t n = batch.size();
+    BatchResult result;
+    result.rejected.assign((n + 63) / 64, 0);
+    const int32_t* cols[NUM_STATS];
+    for (int s = 0; s < NUM_STATS; ++s) cols[s] = batch.cols[s].data();
+    VALIDATE_KERNEL.fn(cols, n, result.rejected.data());
+    uint32_t players = (uint32_t)league.players.size();
+    for (size_t i = 0; i < n; ++i) {
+        result.rejected[i >> 6] |= (uint64_t)((uint32_t)batch.player[i] >= players) << (i & 63);
     }
-    cout << "\nPlayers:\n"<<endl;
-    for (size_t i = 0; i < players.size(); ++i) {
-        cout << (i + 1) << ". " << players[i].name << " (" << players[i].games.size() << " games)\n"<<endl;
+    BSTATS_BYTES(PROBE_INGEST_BATCH, n * sizeof(int32_t) * (NUM_STATS + 2), 0);
+    result.accepted = league.addGames(batch, result.rejected);
+    return result;
+}
+
+// Ingest a CSV in the league export layout (Player,Date,Points,...). Rows
+// for players not in the league add the player. Rows that break a
+// box-score rule are skipped and their line numbers reported on log; a
+// row that cannot be parsed at all aborts the ingest before anything is added.
+bool ingestLeagueCSV(League& league, const string& filename, ostream& log = console) {
+    string data;
+    if (!readWholeFile(filename, data)) {
+        log << "Error opening '" << filename << "' for ingest.\n\n";
+        return false;
     }
-    int choice = readInt("Select player number (0 to cancel): ");
-    if (choice == 0) return -1;
-    if (choice < 1 || choice >(int)players.size()) {
-        cout << "Invalid selection.\n"<<endl;
-        return -1;
+    TextCursor cur(data.data(), data.data() + data.size());
+    string_view line;
+    if (!cur.nextLine(line) || line.compare(0, 12, "Player,Date,") != 0) {
+        log << "Error: " << filename << " line 1: expected the 'Player,Date,Points,...' header.\n\n";
+        return false;
     }
-    return choice - 1;
+    auto fail = [&](const string& error) {
+        log << "Error: " << filename << " line " << cur.line << ": " << error << ".\n\n";
+        return false;
+        };
+
+    GameBatch batch;
+    vector<size_t> lineOf; // file line of each batch row
+    vector<string> added;  // players to create, in order of first appearance
+    unordered_map<string, int32_t> newIdx;
+    vector<bool> pinned(league.players.size(), false);
+    string name;
+    int32_t date, v[NUM_STATS];
+    uint16_t dims[NUM_DIMS];
+    string error;
+    while (cur.nextLine(line)) {
+        if (line.empty()) continue;
+        string_view rest = line;
+        if (!nextCsvField(rest, name)) return fail("unterminated quoted player name");
+        if (name.empty()) return fail("empty player name");
+        if (!parseCsvRow(rest, date, v, dims, error)) return fail(error);
+        int32_t idx = league.find(name);
+        if (idx >= 0 && !pinned[idx]) {
+            // Lazily loaded players must be in memory before games are appended
+            if (!pageIn(league, idx, PAGE_PIN, log)) return false;
+            pinned[idx] = true;
+        }
+        if (idx < 0) {
+            auto it = newIdx.emplace(name, (int32_t)(league.players.size() + added.size())).first;
+            if (it->second == (int32_t)(league.players.size() + added.size())) added.push_back(name);
+            idx = it->second;
+        }
+        batch.add(idx, date, v, dims);
+        lineOf.push_back(cur.line);
+    }
+    for (const auto& n : added) league.add(n);
+
+    BatchResult result = ingestBatch(league, batch);
+    status(log) << "Ingested " << result.accepted << " games from '" << filename << "' (" << added.size()
+        << " new players).\n\n";
+    size_t rejected = batch.size() - result.accepted;
+    if (rejected == 0) return true;
+    const size_t SHOWN = 10;
+    log << "Rejected " << rejected << (rejected == 1 ? " row" : " rows") << " that break a box-score rule (line";
+    for (size_t i = 0, shown = 0; i < batch.size() && shown < SHOWN; ++i) {
+        if (!result.isRejected(i)) continue;
+        log << (shown++ ? ", " : " ") << lineOf[i];
+    }
+    log << (rejected > SHOWN ? ", ...).\n\n" : ").\n\n");
+    return true;
 }
 
-// Enter a single game's stats interactively and append to player's games
-void enterGameForPlayer(Player& p) {
-    GameStats g;
-    cout << "\nEntering new game for " << p.name << ". Use YYYY-MM-DD for date.\n"<<endl;
-    g.date = readLine("Date (YYYY-MM-DD): ");
-    g.points = readInt("Points: ");
-    g.rebounds = readInt("Rebounds: ");
-    g.assists = readInt("Assists: ");
-    g.steals = readInt("Steals: ");
-    g.blocks = readInt("Blocks: ");
-    g.fgm = readInt("Field goals made (FGM): ");
-    g.fga = readInt("Field goals attempted (FGA): ");
-    g.threem = readInt("3-pointers made (3PM): ");
-    g.threea = readInt("3-pointers attempted (3PA): ");
-    g.ftm = readInt("Free throws made (FTM): ");
-    g.fta = readInt("Free throws attempted (FTA): ");
+// ======================================================
+// BENCHMARKS: synthetic leagues and timed runs of the main paths
+// ======================================================
 
-    // Basic validation: ensure subcounts don't exceed totals
-    if (g.threem > g.fgm) {
-        cout << "Warning: 3PM > FGM. Adjusting FGM to be at least 3PM.\n";
-        g.fgm = g.threem;
+// Replace the league with `players` synthetic players of `games` games
+// each. Every player gets shooting volume and accuracy, rebounding and
+// playmaking levels drawn once; each game is drawn around them, with shots
+// kept consistent (makes <= attempts, 3PM <= FGM, points = 2*FGM + 3PM + FTM).
+// Games are every other day from the start of a season. Each player is on
+// one of GENERATED_TEAMS teams, alternating home and away against the rest.
+void generateLeague(League& league, size_t players, size_t games, uint64_t seed) {
+    mt19937_64 rng(seed);
+    auto clamp01 = [](double v, double lo, double hi) { return min(hi, max(lo, v)); };
+    auto draw = [&](double mean) { return mean > 0 ? poisson_distribution<int>(mean)(rng) : 0; };
+    auto makes = [&](int attempts, double pct) { return binomial_distribution<int>(attempts, pct)(rng); };
+    const int32_t SEASON_START = daysFromCivil(2024, 10, 22);
+
+    const size_t GENERATED_TEAMS = 30;
+
+    league.clear();
+    league.players.reserve(players);
+    char name[32];
+    uint16_t teams[GENERATED_TEAMS];
+    for (size_t t = 0; t < GENERATED_TEAMS; ++t) {
+        snprintf(name, sizeof(name), "Team %02zu", t + 1);
+        if (!teamDict.idOf(name, teams[t])) teams[t] = 0; // no room: leave games untagged
     }
+    for (size_t i = 0; i < players; ++i) {
+        snprintf(name, sizeof(name), "Player %06zu", i + 1);
+        Player& p = league.players[league.add(name)];
+        double fga = gamma_distribution<double>(4.0, 3.0)(rng);
+        double fgPct = clamp01(normal_distribution<double>(0.46, 0.05)(rng), 0.30, 0.65);
+        double threeRate = uniform_real_distribution<double>(0.05, 0.5)(rng);
+        double threePct = clamp01(normal_distribution<double>(0.35, 0.05)(rng), 0.15, 0.50);
+        double fta = fga * uniform_real_distribution<double>(0.1, 0.4)(rng);
+        double ftPct = clamp01(normal_distribution<double>(0.77, 0.08)(rng), 0.40, 0.95);
+        double reb = gamma_distribution<double>(2.5, 2.0)(rng);
+        double ast = gamma_distribution<double>(2.0, 1.8)(rng);
+        double stl = gamma_distribution<double>(2.0, 0.4)(rng);
+        double blk = gamma_distribution<double>(1.5, 0.4)(rng);
 
-    p.games.push_back(g);
-    cout << "Game added for " << p.name << " (" << g.date << ").\n"<<endl;
+        p.games.reserve(games);
+        int32_t v[NUM_STATS];
+        for (size_t j = 0; j < games; ++j) {
+            v[STAT_FGA] = draw(fga);
+            v[STAT_FGM] = makes(v[STAT_FGA], fgPct);
+            v[STAT_3PA] = makes(v[STAT_FGA], threeRate);
+            v[STAT_3PM] = min(makes(v[STAT_3PA], threePct), v[STAT_FGM]);
+            v[STAT_FTA] = draw(fta);
+            v[STAT_FTM] = makes(v[STAT_FTA], ftPct);
+            v[STAT_POINTS] = 2 * v[STAT_FGM] + v[STAT_3PM] + v[STAT_FTM];
+            v[STAT_REBOUNDS] = draw(reb);
+            v[STAT_ASSISTS] = draw(ast);
+            v[STAT_STEALS] = draw(stl);
+            v[STAT_BLOCKS] = draw(blk);
+            uint16_t dims[NUM_DIMS];
+            dims[DIM_TEAM] = teams[i % GENERATED_TEAMS];
+            dims[DIM_OPPONENT] = teams[(i + 1 + j % (GENERATED_TEAMS - 1)) % GENERATED_TEAMS];
+            dims[DIM_VENUE] = j % 2 ? VENUE_AWAY : VENUE_HOME;
+            p.games.appendUntracked(SEASON_START + 2 * (int32_t)j, v, dims);
+        }
+        p.games.retotal();
+        league.touch((int)i);
+    }
 }
 
-// Edit an existing game for a player by index (1-based shown to user)
-void editGame(Player& p) {
-    if (p.games.empty()) { cout << "No games to edit.\n"; return; }
+// Stream buffer that drops everything, so benchmarks pay for formatting
+// but not for terminal output
+class DiscardBuffer : public streambuf {
+protected:
+    int_type overflow(int_type c) override {
+        setp(buf, buf + sizeof(buf));
+        return traits_type::not_eof(c);
+    }
+
+private:
+    char buf[4096];
+};
 
-    cout << "\nGames for " << p.name << ":\n"<<endl;
-    for (size_t i = 0; i < p.games.size(); ++i) {
-        cout << (i + 1) << ". " << p.games[i].date << " - " << p.games[i].points << " pts\n";
+struct BenchOptions {
+    vector<size_t> sizes = { 10, 1000, 100000, 1000000 }; // total games per league
+    int reps = 5;
+    uint64_t seed = 42;
+    string dir; // scratch files; empty = system temp directory
+};
+
+// Nearest-rank percentile of sorted samples
+double percentile(const vector<double>& sorted, double q) {
+    size_t rank = (size_t)ceil(q * sorted.size());
+    return sorted[min(sorted.size() - 1, rank > 0 ? rank - 1 : 0)];
+}
+
+// Time the load/save/export/aggregation/sort/report paths on synthetic
+// leagues of each size and print one JSON document: every operation's
+// wall-clock samples summarised as min/p50/p90/p99/max milliseconds and
+// games per second at the median.
+bool runBenchmarks(const BenchOptions& opt, ostream& out, ostream& log) {
+    using Clock = chrono::steady_clock;
+    error_code ec;
+    filesystem::path dir = opt.dir.empty() ? filesystem::temp_directory_path(ec) / "bstats_bench" : filesystem::path(opt.dir);
+    filesystem::create_directories(dir, ec);
+    if (ec) {
+        log << "Cannot create benchmark directory '" << dir.string() << "': " << ec.message() << ".\n";
+        return false;
     }
-    int idx = readInt("Enter game number to edit (0 to cancel): ");
-    if (idx == 0) return;
-    if (idx < 1 || idx >(int)p.games.size()) { cout << "Invalid game number.\n"; return; }
+    string dataFile = (dir / "bench_players.txt").string();
+    string csvFile = (dir / "bench_player.csv").string();
+    string archiveFile = (dir / "bench_players.barc").string();
+    DiscardBuffer discardBuf;
+    ostream discard(&discardBuf);
+
+    out << "{\n  \"kernel\": \"" << TOTALS_KERNEL.name << "\",\n  \"threads\": " << workerCount()
+        << ",\n  \"reps\": " << opt.reps << ",\n  \"results\": [";
+    bool first = true, ok = true;
+    for (size_t size : opt.sizes) {
+        // N players x M games, M about one season
+        size_t players = max<size_t>(1, size / 82);
+        size_t games = max<size_t>(1, size / players);
+        size_t total = players * games;
+        League league;
+        generateLeague(league, players, games, opt.seed);
+        status(log) << "Benchmarking " << players << " players x " << games << " games.\n";
+
+        // setup runs before every sample without being timed
+        auto bench = [&](const char* op, auto setup, auto run) {
+            vector<double> ms;
+            for (int r = 0; r < opt.reps; ++r) {
+                setup();
+                auto t0 = Clock::now();
+                run();
+                ms.push_back(chrono::duration<double, milli>(Clock::now() - t0).count());
+            }
+            sort(ms.begin(), ms.end());
+            double p50 = percentile(ms, 0.5);
+            out << (first ? "\n" : ",\n") << "    {\"op\": \"" << op << "\", \"players\": " << players
+                << ", \"games\": " << total << fixed << setprecision(4)
+                << ", \"min_ms\": " << ms.front() << ", \"p50_ms\": " << p50
+                << ", \"p90_ms\": " << percentile(ms, 0.9) << ", \"p99_ms\": " << percentile(ms, 0.99)
+                << ", \"max_ms\": " << ms.back() << setprecision(0)
+                << ", \"games_per_sec\": " << (p50 > 0 ? total / (p50 / 1000.0) : 0.0) << "}";
+            first = false;
+        };
+        auto none = []() {};
+        vector<Player>& ps = league.players;
+
+        bench("save_text", none, [&]() { ok &= saveAllPlayersToFile(ps, dataFile, discard); });
+        {
+            League loaded;
+            bench("load_text", none, [&]() { ok &= loadAllPlayersFromFile(loaded, dataFile, discard); });
+        }
+        bench("save_archive", none, [&]() { ok &= saveArchive(ps, archiveFile, discard); });
+        {
+            League loaded;
+            bench("load_archive", none, [&]() { ok &= loadArchive(loaded, archiveFile, discard); });
+        }
+        bench("export_csv", none, [&]() {
+            for (const auto& p : ps) ok &= exportPlayerToCSV(p, csvFile, discard);
+            });
+        bench("show_totals", none, [&]() { for (const auto& p : ps) showTotals(p, discard); });
+        bench("show_averages", none, [&]() { for (const auto& p : ps) showAverages(p, discard); });
+        bench("show_advanced", none, [&]() { for (const auto& p : ps) showAdvancedMetrics(p, ALL_METRICS, discard); });
+        {
+            ChartOptions games, monthly, fit;
+            games.width = monthly.width = fit.width = 120;
+            monthly.bucket = CHART_MONTH;
+            fit.bucket = CHART_FIT;
+            bench("show_chart", none, [&]() { for (const auto& p : ps) showAsciiChart(p, games, discard); });
+            bench("show_chart_month", none, [&]() { for (const auto& p : ps) showAsciiChart(p, monthly, discard); });
+            bench("show_chart_fit", none, [&]() { for (const auto& p : ps) showAsciiChart(p, fit, discard); });
+        }
+        volatile double perSink = 0;
+        bench("simple_per", none, [&]() {
+            double sum = 0;
+            for (const auto& p : ps) sum += simplePER(p);
+            perSink = sum;
+            });
+        // A sort selects the order; the cached view is built on first listing.
+        // Rewriting game 0 in place drops the cached views before each sample.
+        auto dropViews = [&]() {
+            for (auto& p : ps) {
+                if (!p.games.empty()) p.games.set(0, p.games[0]);
+            }
+            };
+        auto sortBy = [&](int key) {
+            for (auto& p : ps) {
+                p.view = key;
+                if (!p.games.empty()) p.shown(0);
+            }
+            };
+        bench("sort_by_date", dropViews, [&]() { sortBy(GameStore::VIEW_BY_DATE); });
+        bench("sort_by_points", dropViews, [&]() { sortBy(STAT_POINTS); });
+        for (auto& p : ps) p.view = Player::VIEW_STORAGE;
+        bench("quick_report", [&]() { league.cache.clear(); }, [&]() { showQuickSummary(league, discard); });
+        bench("quick_report_cached", none, [&]() { showQuickSummary(league, discard); });
+        bench("quick_report_one_changed", [&]() { league.touch(0); }, [&]() { showQuickSummary(league, discard); });
+        {
+            vector<const Player*> all = allPlayers(ps);
+            vector<GroupRow> rows;
+            bench("group_by_team_season", none, [&]() {
+                ok &= groupGames(league, all, { GROUP_TEAM, GROUP_SEASON }, rows, discard);
+                });
+        }
+
+        // Compact mode on a copy of the league: packing every player into the
+        // pool, and a cold quick report that decodes each player and drops it
+        {
+            League packed;
+            for (const auto& p : ps) packed.merge(Player(p));
+            bench("compact_league", [&]() { ok &= pageInAll(packed, log); }, [&]() { compactLeague(packed); });
+            bench("quick_report_compact", [&]() { packed.cache.clear(); }, [&]() { showQuickSummary(packed, discard); });
+        }
+
+        // Every game of the league as one feed batch, 1% with bad points,
+        // ingested into an empty copy of the roster
+        GameBatch batch;
+        batch.reserve(total);
+        int32_t row[NUM_STATS];
+        for (size_t i = 0; i < ps.size(); ++i) {
+            for (size_t j = 0; j < ps[i].games.size(); ++j) {
+                ps[i].games.values(j, row);
+                if (batch.size() % 100 == 99) ++row[STAT_POINTS];
+                batch.add((int32_t)i, ps[i].games.date(j), row);
+            }
+        }
+        League feed;
+        bench("ingest_batch", [&]() {
+            feed.clear();
+            for (const auto& p : ps) feed.add(p.name);
+            }, [&]() { ok &= ingestBatch(feed, batch).accepted == total - total / 100; });
+        feed.clear();
+
+        // Readers report on live copies of every player while one writer keeps
+        // adding games; runs last because the writer grows the league
+        startLive(league, log);
+        for (unsigned readers : { 1u, 2u, 4u, 8u }) {
+            string op = "live_reports_" + to_string(readers) + "t";
+            bench(op.c_str(), none, [&]() {
+                atomic<bool> done(false);
+                thread writer([&]() {
+                    mt19937_64 rng(opt.seed);
+                    GameStats g;
+                    g.date = ps.empty() ? 0 : ps[0].games.date(0);
+                    g.points = 20;
+                    while (!done.load(memory_order_relaxed)) league.addGame((int)(rng() % ps.size()), g);
+                    });
+                vector<thread> pool;
+                for (unsigned t = 0; t < readers; ++t) {
+                    pool.emplace_back([&, t]() {
+                        DiscardBuffer buf;
+                        ostream os(&buf);
+                        for (size_t i = t; i < league.live.size(); i += readers) {
+                            LiveStore::Snapshot p = league.live.read(i);
+                            showTotals(*p, os);
+                            showAverages(*p, os);
+                            showBestScoringGames(*p, os);
+                        }
+                        });
+                }
+                for (auto& t : pool) t.join();
+                done = true;
+                writer.join();
+                });
+        }
+        league.live.stop();
+        (void)perSink;
+    }
+    out << "\n  ]\n}\n";
+    out.flush();
+    filesystem::remove(dataFile, ec);
+    filesystem::remove(csvFile, ec);
+    filesystem::remove(archiveFile, ec);
+    if (!ok) log << "Some benchmark runs failed to read or write their scratch files.\n";
+    return ok;
+}
+
+// ======================================================
+// QUERY SERVER: JSON over HTTP/1.1 on epoll event loops
+// ======================================================
 
-    GameStats& g = p.games[idx - 1];
-    cout << "Editing Game " << idx << " (" << g.date << "). Press enter to keep current value.\n";
+// Endpoints (GET; names are percent-encoded in the path):
+//   /players                 every player's name and game count
+//   /players/<name>/totals   counting stats and shooting percentages
+//   /players/<name>/averages per-game averages and simple PER
+//   /players/<name>/per      simple PER
+//   /players/<name>/best     best scoring game(s)
+//   /players/<name>/metrics  the advanced metrics table
+//   /players/<name>/csv      the player's games as CSV rows
+// The server only reads the league, so its threads share it without locks.
+
+void jsonString(string& out, string_view s) {
+    out += '"';
+    for (char c : s) {
+        if (c == '"' || c == '\\') { out += '\\'; out += c; }
+        else if ((unsigned char)c < 0x20) {
+            char esc[8];
+            snprintf(esc, sizeof(esc), "\\u%04x", (unsigned char)c);
+            out += esc;
+        }
+        else out += c;
+    }
+    out += '"';
+}
 
-    // Helper lambda: read an int or keep current by empty line
-    auto readIntKeep = [&](const string& prompt, int& field) {
-        cout << prompt << " [" << field << "]: ";
-        string line; getline(cin, line);
-        if (line.empty()) return; // keep current
-        stringstream ss(line);
-        int v; if (ss >> v) field = v;
-        else cout << "Invalid input; keeping previous value.\n"<<endl;
-        };
+void jsonNumber(string& out, double v, int decimals = 2) {
+    char buf[32];
+    out.append(buf, to_chars(buf, buf + sizeof(buf), v, chars_format::fixed, decimals).ptr);
+}
 
-    cout << "Date (current " << g.date << "): "<<endl;
-    string newDate; getline(cin, newDate);
-    if (!newDate.empty()) g.date = newDate;
+void jsonNumber(string& out, long long v) {
+    char buf[24];
+    out.append(buf, to_chars(buf, buf + sizeof(buf), v).ptr);
+}
 
-    readIntKeep("Points", g.points);
-    readIntKeep("Rebounds", g.rebounds);
-    readIntKeep("Assists", g.assists);
-    readIntKeep("Steals", g.steals);
-    readIntKeep("Blocks", g.blocks);
-    readIntKeep("FGM", g.fgm);
-    readIntKeep("FGA", g.fga);
-    readIntKeep("3PM", g.threem);
-    readIntKeep("3PA", g.threea);
-    readIntKeep("FTM", g.ftm);
-    readIntKeep("FTA", g.fta);
+// "key": with a leading comma unless it is the object's first member
+void jsonKey(string& out, string_view key) {
+    if (out.back() != '{' && out.back() != '[') out += ',';
+    jsonString(out, key);
+    out += ':';
+}
 
-    cout << "Game updated.\n"<<endl;
+// Decode %XX escapes in a URL path segment; false if one is malformed
+bool urlDecode(string_view in, string& out) {
+    out.clear();
+    for (size_t i = 0; i < in.size(); ++i) {
+        if (in[i] != '%') { out += in[i]; continue; }
+        unsigned v = 0;
+        if (i + 2 >= in.size() || from_chars(in.data() + i + 1, in.data() + i + 3, v, 16).ptr != in.data() + i + 3) return false;
+        out += (char)v;
+        i += 2;
+    }
+    return true;
 }
 
-// Delete a game by number (1-based)
-void deleteGame(Player& p) {
-    if (p.games.empty()) { cout << "No games to delete.\n"; return; }
+// Build the body for GET target; returns the HTTP status. With live set
+// the players are read from league.live (see LIVE SERVER) and the rest of
+// the league is not touched, since a writer may be changing it.
+int handleQuery(const League& league, string_view target, string& body, const char*& type, bool live = false) {
+    BSTATS_PROBE(PROBE_SERVE_REQUEST);
+    type = "application/json";
+    body.clear();
+    size_t q = target.find('?');
+    if (q != string_view::npos) target = target.substr(0, q);
+    auto error = [&](int status, const char* message) {
+        body = "{\"error\":";
+        jsonString(body, message);
+        body += '}';
+        return status;
+        };
 
-    cout << "\nGames for " << p.name << ":\n"<<endl;
-    for (size_t i = 0; i < p.games.size(); ++i) {
-        cout << (i + 1) << ". " << p.games[i].date << " - " << p.games[i].points << " pts\n";
+    if (target == "/players" || target == "/players/") {
+        body = "{\"players\":[";
+        size_t n = live ? league.live.size() : league.players.size();
+        for (size_t i = 0; i < n; ++i) {
+            LiveStore::Snapshot hold = live ? league.live.read(i) : nullptr;
+            if (live && !hold) break;
+            const Player& q = live ? *hold : league.players[i];
+            body += i ? ",{" : "{";
+            jsonKey(body, "name");
+            jsonString(body, q.name);
+            jsonKey(body, "games");
+            jsonNumber(body, (long long)q.games.size());
+            body += '}';
+        }
+        body += "]}";
+        return 200;
     }
-    int idx = readInt("Enter game number to delete (0 to cancel): ");
-    if (idx == 0) return;
-    if (idx < 1 || idx >(int)p.games.size()) { cout << "Invalid game number.\n"; return; }
+    const string_view PREFIX = "/players/";
+    if (target.compare(0, PREFIX.size(), PREFIX) != 0) return error(404, "unknown path");
+    string_view rest = target.substr(PREFIX.size());
+    size_t slash = rest.find('/');
+    if (slash == string_view::npos) return error(404, "missing report: totals, averages, per, best, metrics or csv");
+    string name;
+    if (!urlDecode(rest.substr(0, slash), name)) return error(400, "bad player name encoding");
+    string_view report = rest.substr(slash + 1);
+    int idx = live ? league.live.find(name) : league.find(name);
+    LiveStore::Snapshot hold = live && idx >= 0 ? league.live.read(idx) : nullptr;
+    if (idx < 0 || (live && !hold)) return error(404, "no such player");
+    const Player& p = live ? *hold : league.players[idx];
+    const GameStore& g = p.games;
+    const StatTotals& totals = g.totals();
+    const long long* t = totals.sum;
+    double n = (double)g.size();
 
-    string confirm = readLine("Type 'DELETE' to confirm deletion: ");
-    if (confirm == "DELETE") {
-        p.games.erase(p.games.begin() + (idx - 1));
-        cout << "Game deleted.\n";
+    body = "{";
+    jsonKey(body, "player");
+    jsonString(body, p.name);
+    jsonKey(body, "games");
+    jsonNumber(body, (long long)g.size());
+    if (report == "totals") {
+        for (int s = 0; s < NUM_STATS; ++s) {
+            jsonKey(body, statKey((StatId)s));
+            jsonNumber(body, t[s]);
+        }
+        for (const ShotDef& d : SHOT_DEFS) {
+            jsonKey(body, d.key);
+            jsonNumber(body, pct(t[d.made], t[d.attempted]));
+        }
+    }
+    else if (report == "averages") {
+        for (int s = 0; s < NUM_STATS; ++s) {
+            if (!*STAT_DEFS[s].perGame) continue;
+            string key = STAT_DEFS[s].perGame;
+            for (char& c : key) c = (char)tolower((unsigned char)c);
+            jsonKey(body, key);
+            jsonNumber(body, n > 0 ? t[s] / n : 0.0);
+        }
+        jsonKey(body, "per");
+        jsonNumber(body, simplePER(p));
+    }
+    else if (report == "per") {
+        jsonKey(body, "per");
+        jsonNumber(body, simplePER(p));
+    }
+    else if (report == "best") {
+        const int32_t* pts = g.column(STAT_POINTS);
+        int32_t best = g.empty() ? 0 : *max_element(pts, pts + g.size());
+        jsonKey(body, "points");
+        if (g.empty()) body += "null";
+        else jsonNumber(body, (long long)best);
+        jsonKey(body, "best");
+        body += '[';
+        for (size_t k = 0; k < g.size(); ++k) {
+            if (pts[k] != best) continue;
+            GameStats gs = g[k];
+            body += body.back() == '[' ? "{" : ",{";
+            jsonKey(body, "game");
+            jsonNumber(body, (long long)k + 1);
+            jsonKey(body, "date");
+            jsonString(body, formatDate(gs.date));
+            jsonKey(body, "points");
+            jsonNumber(body, (long long)gs.points);
+            jsonKey(body, "fg_pct");
+            jsonNumber(body, pct(gs.fgm, gs.fga), 1);
+            jsonKey(body, "3p_pct");
+            jsonNumber(body, pct(gs.threem, gs.threea), 1);
+            body += '}';
+        }
+        body += ']';
+    }
+    else if (report == "metrics") {
+        MetricInputs m = gatherMetrics(g, ALL_METRICS);
+        for (const MetricDef& d : METRICS) {
+            jsonKey(body, d.key);
+            jsonNumber(body, d.value(m), d.decimals);
+        }
+    }
+    else if (report == "csv") {
+        type = "text/csv";
+        body.assign(CSV_HEADER);
+        appendCsvRows(body, p);
+        return 200;
     }
     else {
-        cout << "Deletion cancelled.\n"<<endl;
+        return error(404, "unknown report: use totals, averages, per, best, metrics or csv");
     }
+    body += '}';
+    return 200;
 }
 
-// ======================================================
-// SORTING FUNCTIONS
-// ======================================================
+struct ServeOptions {
+    string host = "127.0.0.1";
+    int port = 8080;
+};
 
-// Sort a player's games by date (ascending). Assumes date strings are YYYY-MM-DD
-void sortGamesByDate(Player& p) {
-    sort(p.games.begin(), p.games.end(), [](const GameStats& a, const GameStats& b) {
-        return a.date < b.date;
-        });
-    cout << "Games sorted by date (oldest -> newest).\n"<<endl;
-}
+#ifdef __linux__
+atomic<bool> serverStop(false);
 
-// Sort a player's games by points (descending)
-void sortGamesByPoints(Player& p) {
-    sort(p.games.begin(), p.games.end(), [](const GameStats& a, const GameStats& b) {
-        return a.points > b.points;
-        });
-    cout << "Games sorted by points (highest -> lowest).\n"<<endl;
-}
+void onStopSignal(int) { serverStop = true; }
 
-// ======================================================
-// STATS REPORTS: totals, averages, best game, ASCII chart
-// ======================================================
+// One client connection: bytes received but not yet parsed, and responses
+// not yet sent. Requests are answered in order, so pipelined requests
+// simply queue up their responses in out.
+struct Connection {
+    int fd;
+    string in, out;
+    size_t sent = 0;
+    bool closeAfter = false;
+    bool writing = false; // EPOLLOUT is registered
+};
 
-// Show totals and shooting percentages
-void showTotals(const Player& p) {
-    if (p.games.empty()) { cout << "No games to report.\n"<<endl; return; }
-
-    int totalPts = 0, totalReb = 0, totalAst = 0, totalStl = 0, totalBlk = 0;
-    int totalFGM = 0, totalFGA = 0, total3M = 0, total3A = 0, totalFTM = 0, totalFTA = 0;
-
-    for (const auto& g : p.games) {
-        totalPts += g.points;
-        totalReb += g.rebounds;
-        totalAst += g.assists;
-        totalStl += g.steals;
-        totalBlk += g.blocks;
-        totalFGM += g.fgm;
-        totalFGA += g.fga;
-        total3M += g.threem;
-        total3A += g.threea;
-        totalFTM += g.ftm;
-        totalFTA += g.fta;
-    }
-
-    cout << fixed << setprecision(2);
-    cout << "\n=== TOTALS for " << p.name << " ===\n"<<endl;
-    cout << "Games: " << p.games.size() << "\n" << endl;
-    cout << "Points: " << totalPts << "\n" << endl;
-    cout << "Rebounds: " << totalReb << "\n" << endl;
-    cout << "Assists: " << totalAst << "\n" << endl;
-    cout << "Steals: " << totalStl << "\n" << endl;
-    cout << "Blocks: " << totalBlk << "\n" << endl;
-    cout << "FG%: " << pct(totalFGM, totalFGA) << "% (" << totalFGM << "/" << totalFGA << ")\n" << endl;
-    cout << "3P%: " << pct(total3M, total3A) << "% (" << total3M << "/" << total3A << ")\n" << endl;
-    cout << "FT%: " << pct(totalFTM, totalFTA) << "% (" << totalFTM << "/" << totalFTA << ")\n" << endl;
+const char* statusText(int status) {
+    switch (status) {
+    case 200: return "OK";
+    case 400: return "Bad Request";
+    case 404: return "Not Found";
+    case 405: return "Method Not Allowed";
+    case 413: return "Payload Too Large";
+    case 431: return "Request Header Fields Too Large";
+    }
+    return "Error";
 }
 
-// Show per-game averages
-void showAverages(const Player& p) {
-    if (p.games.empty()) { cout << "No games to report.\n"; return; }
-
-    double totalPts = 0, totalReb = 0, totalAst = 0, totalStl = 0, totalBlk = 0;
-    for (const auto& g : p.games) {
-        totalPts += g.points;
-        totalReb += g.rebounds;
-        totalAst += g.assists;
-        totalStl += g.steals;
-        totalBlk += g.blocks;
-    }
-    cout << fixed << setprecision(2);
-    cout << "\n=== AVERAGES for " << p.name << " ===\n" << endl;
-    cout << "PPG: " << totalPts / p.games.size() << "\n" << endl;
-    cout << "RPG: " << totalReb / p.games.size() << "\n" << endl;
-    cout << "APG: " << totalAst / p.games.size() << "\n" << endl;
-    cout << "SPG: " << totalStl / p.games.size() << "\n" << endl;
-    cout << "BPG: " << totalBlk / p.games.size() << "\n" << endl;
-    cout << "Simple PER: " << simplePER(p) << "\n" << endl;
+void appendResponse(string& out, int status, const char* type, const string& body, bool close) {
+    char head[160];
+    int len = snprintf(head, sizeof(head), "HTTP/1.1 %d %s\r\nContent-Type: %s\r\nContent-Length: %zu\r\n%s\r\n",
+        status, statusText(status), type, body.size(), close ? "Connection: close\r\n" : "");
+    out.append(head, len);
+    out += body;
 }
 
-// Find and show the best scoring game(s)
-void showBestScoringGames(const Player& p) {
-    if (p.games.empty()) { cout << "No games to report.\n"; return; }
-    int bestPts = p.games[0].points;
-    for (const auto& g : p.games) bestPts = max(bestPts, g.points);
+// True if the header block contains this header with this value (case-insensitive)
+bool hasHeader(string_view headers, string_view name, string_view value) {
+    auto lower = [](string_view s) {
+        string r(s);
+        for (char& c : r) c = (char)tolower((unsigned char)c);
+        return r;
+        };
+    string h = lower(headers) + "\r\n", key = "\r\n" + lower(name) + ":";
+    for (size_t at = h.find(key); at != string::npos; at = h.find(key, at + 1)) {
+        size_t v = at + key.size(), end = h.find("\r\n", v);
+        if (h.substr(v, end - v).find(lower(value)) != string::npos) return true;
+    }
+    return false;
+}
+
+// Answer every complete request in c.in; a malformed or oversized request
+// sets closeAfter so the connection ends once its error response is sent.
+// Returns the number of requests answered.
+size_t answerRequests(const League& league, Connection& c, bool live = false) {
+    const size_t MAX_HEADER = 16 << 10, MAX_BODY = 64 << 10;
+    size_t pos = 0;
+    string body;
+    const char* type;
+    size_t answered = 0;
+    while (!c.closeAfter) {
+        size_t end = c.in.find("\r\n\r\n", pos);
+        if (end == string::npos) {
+            if (c.in.size() - pos > MAX_HEADER) {
+                appendResponse(c.out, 431, "application/json", "{\"error\":\"request too large\"}", true);
+                c.closeAfter = true;
+            }
+            break;
+        }
+        string_view head(c.in.data() + pos, end - pos);
+        size_t lineEnd = min(head.find("\r\n"), head.size());
+        string_view line = head.substr(0, lineEnd), headers = head.substr(lineEnd);
+        size_t sp1 = line.find(' '), sp2 = line.rfind(' ');
+        // Skip any request body so the next pipelined request lines up
+        size_t bodyLen = 0;
+        string lowerHead(headers);
+        for (char& ch : lowerHead) ch = (char)tolower((unsigned char)ch);
+        size_t cl = lowerHead.find("\r\ncontent-length:");
+        if (cl != string::npos) {
+            const char* v = lowerHead.c_str() + cl + 17;
+            while (*v == ' ') ++v;
+            auto parsed = from_chars(v, lowerHead.c_str() + lowerHead.size(), bodyLen);
+            // A body that cannot be skipped ends the connection, like an oversized header
+            if (parsed.ec != errc() || bodyLen > MAX_BODY) {
+                bool bad = parsed.ec == errc::invalid_argument;
+                appendResponse(c.out, bad ? 400 : 413, "application/json",
+                    bad ? "{\"error\":\"malformed Content-Length\"}" : "{\"error\":\"request body too large\"}", true);
+                c.closeAfter = true;
+                break;
+            }
+        }
+        if (c.in.size() - (end + 4) < bodyLen) break;
 
-    cout << "\n=== Best Scoring Game(s): " << bestPts << " pts ===\n";
-    for (size_t i = 0; i < p.games.size(); ++i) {
-        if (p.games[i].points == bestPts) {
-            auto& g = p.games[i];
-            cout << (i + 1) << ". " << g.date << " - " << g.points << " pts, "
-                << "FG%=" << fixed << setprecision(1) << pct(g.fgm, g.fga) << "%, "
-                << "3P=" << pct(g.threem, g.threea) << "%\n";
+        bool http10 = line.substr(sp2 + 1) == "HTTP/1.0";
+        c.closeAfter = hasHeader(headers, "Connection", "close") || (http10 && !hasHeader(headers, "Connection", "keep-alive"));
+        int status;
+        if (sp1 == string_view::npos || sp1 == sp2) {
+            status = 400;
+            type = "application/json";
+            body = "{\"error\":\"malformed request line\"}";
+            c.closeAfter = true;
+        }
+        else if (line.substr(0, sp1) != "GET") {
+            status = 405;
+            type = "application/json";
+            body = "{\"error\":\"only GET is supported\"}";
+        }
+        else {
+            status = handleQuery(league, line.substr(sp1 + 1, sp2 - sp1 - 1), body, type, live);
         }
+        appendResponse(c.out, status, type, body, c.closeAfter);
+        pos = end + 4 + bodyLen;
+        ++answered;
     }
+    c.in.erase(0, pos);
+    return answered;
 }
 
-// ASCII bar chart of points per game. Each '*' represents 2 points (adjust scale if desired)
-void showAsciiChart(const Player& p) {
-    if (p.games.empty()) { cout << "No games to chart.\n"; return; }
-    cout << "\n=== ASCII Chart: Points per Game (each '*' = 2 points) ===\n" << endl;
-    for (size_t i = 0; i < p.games.size(); ++i) {
-        int stars = (int)round(p.games[i].points / 2.0);
-        cout << setw(3) << (i + 1) << " [" << p.games[i].date << "] "
-            << setw(3) << p.games[i].points << " | ";
-        for (int s = 0; s < stars; ++s) cout << '*';
-        cout << '\n';
+// Send what fits into the socket; false once the connection should close
+bool flushConnection(int ep, Connection& c) {
+    while (c.sent < c.out.size()) {
+        ssize_t n = send(c.fd, c.out.data() + c.sent, c.out.size() - c.sent, MSG_NOSIGNAL);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            if (errno != EAGAIN && errno != EWOULDBLOCK) return false;
+            break;
+        }
+        c.sent += (size_t)n;
+    }
+    BSTATS_BYTES(PROBE_SERVE_REQUEST, 0, c.sent);
+    bool pending = c.sent < c.out.size();
+    if (!pending) {
+        c.out.clear();
+        c.sent = 0;
+        if (c.closeAfter) return false;
+    }
+    if (pending != c.writing) {
+        epoll_event ev = {};
+        ev.events = EPOLLIN | EPOLLRDHUP | (pending ? (uint32_t)EPOLLOUT : 0u);
+        ev.data.ptr = &c;
+        epoll_ctl(ep, EPOLL_CTL_MOD, c.fd, &ev);
+        c.writing = pending;
     }
+    return true;
 }
 
-// ======================================================
-// FILE I/O: Save/Load all players, Export CSV for a player
-// ======================================================
-
-// Save all players and their games to a text file in a simple format.
-// Format:
-// <numPlayers>
-// For each player:
-//   <name>
-//   <numGames>
-//   For each game: date points rebounds assists steals blocks fgm fga threem threea ftm fta
-void saveAllPlayersToFile(const vector<Player>& players, const string& filename = "players_data.txt") {
-    ofstream out(filename);
-    if (!out) {
-        cout << "Error opening '" << filename << "' for writing.\n" << endl;
-        return;
-    }
-    out << players.size() << '\n';
-    for (const auto& p : players) {
-        // Escape newline issues by writing name on a single line (no internal newlines allowed)
-        out << p.name << '\n';
-        out << p.games.size() << '\n';
-        for (const auto& g : p.games) {
-            // Write each field separated by spaces; date stays as string (YYYY-MM-DD)
-            out << g.date << ' '
-                << g.points << ' '
-                << g.rebounds << ' '
-                << g.assists << ' '
-                << g.steals << ' '
-                << g.blocks << ' '
-                << g.fgm << ' ' << g.fga << ' '
-                << g.threem << ' ' << g.threea << ' '
-                << g.ftm << ' ' << g.fta << '\n';
+// One event loop: accepts connections from the shared listening socket
+// (EPOLLEXCLUSIVE wakes one loop per new connection) and serves them
+// without blocking. The loops together are the server's thread pool.
+void serveLoop(const League& league, int listenFd, atomic<uint64_t>& served, bool live = false) {
+    int ep = epoll_create1(EPOLL_CLOEXEC);
+    epoll_event ev = {};
+    ev.events = EPOLLIN | EPOLLEXCLUSIVE;
+    ev.data.ptr = nullptr;
+    epoll_ctl(ep, EPOLL_CTL_ADD, listenFd, &ev);
+    vector<unique_ptr<Connection>> conns; // by file descriptor
+    auto closeConnection = [&](Connection* c) {
+        epoll_ctl(ep, EPOLL_CTL_DEL, c->fd, nullptr);
+        ::close(c->fd);
+        conns[c->fd].reset();
+        };
+    epoll_event events[128];
+    char buf[64 << 10];
+    while (!serverStop) {
+        int n = epoll_wait(ep, events, 128, 100);
+        for (int e = 0; e < n; ++e) {
+            if (!events[e].data.ptr) {
+                int fd;
+                while ((fd = accept4(listenFd, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC)) >= 0) {
+                    int one = 1;
+                    setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+                    if ((size_t)fd >= conns.size()) conns.resize(fd + 1);
+                    conns[fd].reset(new Connection{ fd, {}, {} });
+                    epoll_event cev = {};
+                    cev.events = EPOLLIN | EPOLLRDHUP;
+                    cev.data.ptr = conns[fd].get();
+                    epoll_ctl(ep, EPOLL_CTL_ADD, fd, &cev);
+                }
+                continue;
+            }
+            Connection* c = (Connection*)events[e].data.ptr;
+            bool open = !(events[e].events & EPOLLERR);
+            if (open && (events[e].events & (EPOLLIN | EPOLLHUP | EPOLLRDHUP))) {
+                for (;;) {
+                    ssize_t got = recv(c->fd, buf, sizeof(buf), 0);
+                    if (got > 0) { c->in.append(buf, (size_t)got); continue; }
+                    if (got < 0 && errno == EINTR) continue;
+                    if (got == 0 || (errno != EAGAIN && errno != EWOULDBLOCK)) c->closeAfter = true;
+                    break;
+                }
+                BSTATS_BYTES(PROBE_SERVE_REQUEST, c->in.size(), 0);
+                bool eof = c->closeAfter;
+                c->closeAfter = false;
+                served.fetch_add(answerRequests(league, *c, live), memory_order_relaxed);
+                c->closeAfter |= eof;
+            }
+            if (open) open = flushConnection(ep, *c);
+            if (!open) closeConnection(c);
         }
     }
-    out.close();
-    cout << "Saved all players to '" << filename << "'.\n" << endl;
+    for (auto& c : conns) if (c) ::close(c->fd);
+    ::close(ep);
 }
 
-// Load players from file created by saveAllPlayersToFile
-void loadAllPlayersFromFile(vector<Player>& players, const string& filename = "players_data.txt") {
-    ifstream in(filename);
-    if (!in) {
-        cout << "No saved file '" << filename << "' found.\n" << endl;
-        return;
+// Listening socket for opt; -1 (with the reason logged) if it cannot be opened
+int openListener(const ServeOptions& opt, ostream& log) {
+    int fd = socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    sockaddr_in addr = {};
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons((uint16_t)opt.port);
+    int one = 1;
+    if (fd < 0 || inet_pton(AF_INET, opt.host.c_str(), &addr.sin_addr) != 1
+        || setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one)) != 0
+        || ::bind(fd, (sockaddr*)&addr, sizeof(addr)) != 0 || listen(fd, SOMAXCONN) != 0) {
+        log << "Cannot listen on " << opt.host << ":" << opt.port << ": " << strerror(errno) << ".\n";
+        if (fd >= 0) ::close(fd);
+        return -1;
     }
-    players.clear();
-    size_t numPlayers = 0;
-    in >> numPlayers;
-    clearInputLine(); // consume '\n' after number
-    for (size_t i = 0; i < numPlayers; ++i) {
-        Player p;
-        p.name = readLine(">> (loading) temporary read to sync - not used"); // workaround - we'll actually read from stream
-        // The above line is a placeholder to align with console IO; we'll instead read directly from 'in'
+    return fd;
+}
+
+// Serve queries on the league until SIGINT or SIGTERM
+bool runServer(League& league, const ServeOptions& opt, ostream& log) {
+    if (!pageInAll(league, log)) return false;
+    int fd = openListener(opt, log);
+    if (fd < 0) return false;
+    serverStop = false;
+    auto oldInt = signal(SIGINT, onStopSignal), oldTerm = signal(SIGTERM, onStopSignal);
+    unsigned threads = workerCount();
+    status(log) << "Serving " << league.players.size() << " players on http://" << opt.host << ":" << opt.port
+        << "/ with " << threads << " threads; Ctrl+C stops.\n";
+    log.flush();
+
+    atomic<uint64_t> served(0);
+    vector<thread> pool;
+    for (unsigned t = 1; t < threads; ++t) pool.emplace_back([&]() { serveLoop(league, fd, served); });
+    serveLoop(league, fd, served);
+    for (auto& t : pool) t.join();
+    ::close(fd);
+    signal(SIGINT, oldInt);
+    signal(SIGTERM, oldTerm);
+    status(log) << "Server stopped after " << served.load() << " requests.\n";
+    return true;
+}
+#endif
+
+// ======================================================
+// LIVE SERVER: reports over HTTP while games are entered
+// ======================================================
+
+// The interactive program can serve the same queries as `serve` on
+// background threads while games keep being entered from the menus. Live
+// access is on for as long as it runs, so the server reads the published
+// copies (see LiveStore) and never the league itself. Changes made outside
+// the League write methods, such as loading or merging a file, are
+// published by sync() after each main menu action.
+class LiveServer {
+public:
+    bool running() const { return listenFd >= 0; }
+
+    bool start(League& league, const ServeOptions& opt, ostream& log = console) {
+#ifdef __linux__
+        if (running() || !pageInAll(league, log)) return false;
+        listenFd = openListener(opt, log);
+        if (listenFd < 0) return false;
+        league.syncLive();
+        serverStop = false;
+        served = 0;
+        unsigned threads = workerCount();
+        for (unsigned t = 0; t < threads; ++t) pool.emplace_back([this, &league]() { serveLoop(league, listenFd, served, true); });
+        status(log) << "Serving live reports on http://" << opt.host << ":" << opt.port << "/ with "
+            << threads << " threads while games are entered.\n\n";
+        return true;
+#else
+        (void)league;
+        (void)opt;
+        log << "The live server needs Linux (epoll).\n\n";
+        return false;
+#endif
     }
-    // Reset and do proper reading without mixing cin/getline and ifstream
-    in.clear();
-    in.seekg(0);
-    in >> numPlayers;
-    string dummy;
-    getline(in, dummy); // consume rest of first line
 
-    for (size_t i = 0; i < numPlayers; ++i) {
-        Player p;
-        getline(in, p.name); // player's name line
-        size_t numGames = 0;
-        in >> numGames;
-        getline(in, dummy); // consume newline
-        for (size_t j = 0; j < numGames; ++j) {
-            GameStats g;
-            in >> g.date
-                >> g.points
-                >> g.rebounds
-                >> g.assists
-                >> g.steals
-                >> g.blocks
-                >> g.fgm >> g.fga
-                >> g.threem >> g.threea
-                >> g.ftm >> g.fta;
-            getline(in, dummy); // consume endline
-            p.games.push_back(g);
-        }
-        players.push_back(p);
-    }
-    in.close();
-    cout << "Loaded " << players.size() << " players from file.\n" << endl;
-}
-
-// Export a single player's games to CSV (useful for importing into Excel)
-void exportPlayerToCSV(const Player& p, const string& filename) {
-    ofstream out(filename);
-    if (!out) {
-        cout << "Error opening '" << filename << "' for CSV export.\n" << endl;
-        return;
+    // Republish what the last menu action changed
+    void sync(League& league) {
+        if (running() && pageInAll(league)) league.syncLive();
     }
-    // CSV header
-    out << "Date,Points,Rebounds,Assists,Steals,Blocks,FGM,FGA,3PM,3PA,FTM,FTA,FG%,3P%,FT%\n";
-    for (const auto& g : p.games) {
-        out << g.date << ','
-            << g.points << ','
-            << g.rebounds << ','
-            << g.assists << ','
-            << g.steals << ','
-            << g.blocks << ','
-            << g.fgm << ','
-            << g.fga << ','
-            << g.threem << ','
-            << g.threea << ','
-            << g.ftm << ','
-            << g.fta << ','
-            << fixed << setprecision(2) << pct(g.fgm, g.fga) << ','
-            << fixed << setprecision(2) << pct(g.threem, g.threea) << ','
-            << fixed << setprecision(2) << pct(g.ftm, g.fta) << '\n';
+
+    void stop(League& league, ostream& log = console) {
+#ifdef __linux__
+        if (!running()) return;
+        serverStop = true;
+        for (auto& t : pool) t.join();
+        pool.clear();
+        ::close(listenFd);
+        listenFd = -1;
+        {
+            lock_guard<mutex> lock(league.writeLock);
+            league.live.stop();
+        }
+        status(log) << "Live server stopped after " << served.load() << " requests.\n\n";
+#else
+        (void)league;
+        (void)log;
+#endif
     }
-    out.close();
-    cout << "Exported " << p.name << " to CSV file '" << filename << "'.\n" << endl;
+
+private:
+    int listenFd = -1;
+    vector<thread> pool;
+    atomic<uint64_t> served{ 0 };
+};
+
+#ifndef __linux__
+bool runServer(League&, const ServeOptions&, ostream& log) {
+    log << "serve needs Linux (epoll).\n";
+    return false;
 }
+#endif
 
 // ======================================================
 // PLAYER MENU: All per-player operations centralized here
 // ======================================================
-void playerMenu(Player& p) {
+void playerMenu(League& league, int player) {
+    if (!pageIn(league, player, PAGE_HOLD)) return;
+    Player& p = league.players[player];
+    uint64_t opened = p.version;
     int choice;
     do {
-        cout << "\n=== Menu for " << p.name << " ===\n" << endl;
-        cout << "1. Add a game\n" << endl;
-        cout << "2. Edit a game\n" << endl;
-        cout << "3. Delete a game\n" << endl;
-        cout << "4. Sort games by date\n" << endl;
-        cout << "5. Sort games by points\n" << endl;
-        cout << "6. Show totals\n" << endl;
-        cout << "7. Show averages & PER\n" << endl;
-        cout << "8. Show best scoring game(s)\n" << endl;
-        cout << "9. ASCII chart: points per game\n" << endl;
-        cout << "10. Export player to CSV\n" << endl;
-        cout << "0. Back to main menu\n" << endl;
+        console << "\n=== Menu for " << p.name << " ===\n\n";
+        console << "1. Add a game\n\n";
+        console << "2. Edit a game\n\n";
+        console << "3. Delete a game\n\n";
+        console << "4. Sort games by date\n\n";
+        console << "5. Sort games by points\n\n";
+        console << "6. Show totals\n\n";
+        console << "7. Show averages & PER\n\n";
+        console << "8. Show best scoring game(s)\n\n";
+        console << "9. ASCII chart: any stat per game, week, month, season or rolling average\n\n";
+        console << "10. Export player to CSV\n\n";
+        console << "11. Query a date range or the last N games\n\n";
+        console << "12. Choose game list order (any stat)\n\n";
+        console << "13. Import games from CSV\n\n";
+        console << "14. Show advanced metrics\n\n";
+        console << "15. Tag a game with team, opponent and home/away\n\n";
+        console << "0. Back to main menu\n\n";
         choice = readInt("Choice: ");
 
         switch (choice) {
-        case 1: enterGameForPlayer(p); break;
-        case 2: editGame(p); break;
-        case 3: deleteGame(p); break;
+        case 1: enterGameForPlayer(league, player); break;
+        case 2: editGame(league, player); break;
+        case 3: deleteGame(league, player); break;
         case 4: sortGamesByDate(p); break;
         case 5: sortGamesByPoints(p); break;
         case 6: showTotals(p); break;
         case 7: showAverages(p); break;
         case 8: showBestScoringGames(p); break;
-        case 9: showAsciiChart(p); break;
+        case 9: chartMenu(p); break;
         case 10: {
             string fname = readLine("Filename for CSV (e.g., player.csv): ");
-            if (fname.empty()) fname = p.name + ".csv";
+            if (fname.empty()) fname = string(p.name) + ".csv";
             exportPlayerToCSV(p, fname);
             break;
         }
+        case 11: queryGamesMenu(p); break;
+        case 12: chooseGameOrder(p); break;
+        case 13: {
+            string fname = readLine("CSV file to import: ");
+            if (!fname.empty() && importPlayerCSV(league, fname, p.name)) rewriteJournaledFile(league);
+            break;
+        }
+        case 14: showAdvancedMetrics(p); break;
+        case 15: tagGame(league, player); break;
         case 0: break;
-        default: cout << "Invalid choice.\n";
+        default: console << "Invalid choice.\n";
         }
+        maybeCompactJournal(league);
     } while (choice != 0);
+    if (p.version != opened) releaseChanged(league, player);
+    else release(league, player);
+}
+
+// ======================================================
+// COMMAND LINE MODE: non-interactive commands for scripts
+// ======================================================
+
+void printUsage(ostream& out) {
+    out << "Usage: bstats [-q] [--threads N] <command> [args] [<command> [args] ...]\n"
+        << "  -q                   quiet: only reports and errors are printed\n"
+        << "  --threads N          worker threads for league-wide reports (default: all cores)\n"
+        << "  --trace <file>       write a Chrome trace-event JSON of the timed operations at exit\n"
+        << "  --memory-budget MiB  keep at most this much of a lazily loaded archive in memory\n"
+        << "  --compact            keep games packed in one pool and decode players only while in use\n"
+        << "Commands run left to right on the same in-memory dataset:\n"
+        << "  load <file>          load a text data file, binary snapshot or archive\n"
+        << "      --player <name>  archives only: load just this player\n"
+        << "      --season <year>  archives only: load just the season starting in <year> (Aug-Jul)\n"
+        << "  merge <file>         add the players and games of another data file\n"
+        << "  save <file>          save all players as a text data file\n"
+        << "  snapshot <file>      save all players as a binary snapshot\n"
+        << "  archive <file>       save all players as a compressed archive\n"
+        << "  convert <in> <out>   convert to another format (default: text <-> snapshot, archive -> text)\n"
+        << "      --text | --snapshot | --archive   output format\n"
+        << "  import <file.csv>    add the games of a CSV in the export layout\n"
+        << "      --player <name>  player to add them to (default: from the file name)\n"
+        << "  ingest <file.csv>    add games for many players from a CSV in the league export\n"
+        << "                       layout (Player,Date,...); rows breaking a box-score rule are skipped\n"
+        << "  report [options]     print reports for every player\n"
+        << "      --summary        one-line summary per player (default)\n"
+        << "      --totals         totals and shooting percentages\n"
+        << "      --avg            per-game averages and simple PER\n"
+        << "      --per            simple PER only\n"
+        << "      --best           best scoring game(s)\n"
+        << "      --advanced       advanced metrics (true shooting, game score, double-doubles, ...)\n"
+        << "      --metrics <list> only these advanced metrics: comma-separated keys from\n"
+        << "                       ts, efg, 3par, ftr, usage, misses, per, gmsc, bestgmsc, dd, td\n"
+        << "      --player <name>  only report on this player\n"
+        << "      --csv-dir <dir>  also export each player to <dir>/<name>.csv\n"
+        << "      --csv <file>     also export the players to one CSV with a Player column\n"
+        << "  query [options]      aggregate a date range or the most recent games\n"
+        << "      --from <date>    first date (YYYY-MM-DD, inclusive)\n"
+        << "      --to <date>      last date (YYYY-MM-DD, inclusive)\n"
+        << "      --last <n>       the n most recent games instead of a date range\n"
+        << "      --player <name>  only query this player\n"
+        << "  top [options]        leaderboard across all players\n"
+        << "      --by <metric>    a stat (points, rebounds, ..., 3pm, fta), ppg/rpg/apg/spg/bpg\n"
+        << "                       for per-game averages, or per (default: points)\n"
+        << "      --games          rank single games instead of players\n"
+        << "      --count <k>      number of entries (default 10)\n"
+        << "  chart [options]      ASCII bar chart of a stat for each player\n"
+        << "      --stat <stat>    points, rebounds, ..., 3pm, fta (default points)\n"
+        << "      --by <bucket>    game, week, month, season, or fit to squeeze the whole\n"
+        << "                       career into the width (default game)\n"
+        << "      --rolling <n>    one bar per game, the average of the last n games\n"
+        << "      --width <n>      columns to fit (default: the terminal width)\n"
+        << "      --player <name>  only chart this player\n"
+        << "  group [options]      games, per-game averages and shooting split into groups\n"
+        << "      --by <keys>      comma-separated keys from player, team, opponent, season,\n"
+        << "                       venue (default team,season)\n"
+        << "      --player <name>  only group this player's games\n"
+        << "  generate [options]   replace the dataset with a synthetic league\n"
+        << "      --players <n>    number of players (default 30)\n"
+        << "      --games <m>      games per player (default 82)\n"
+        << "      --seed <s>       random seed (default 42)\n"
+        << "  bench [options]      time the main code paths on synthetic leagues, print JSON\n"
+        << "      --sizes <list>   comma-separated total game counts (default 10,1000,100000,1000000)\n"
+        << "      --reps <r>       timed samples per operation (default 5)\n"
+        << "      --dir <dir>      directory for scratch files (default: system temp)\n"
+        << "  serve [options]      answer JSON queries over HTTP until Ctrl+C (Linux)\n"
+        << "      --port <n>       TCP port (default 8080)\n"
+        << "      --bind <addr>    IPv4 address to listen on (default 127.0.0.1)\n"
+        << "  memory               print the bytes held by games, indexes and names, per player and game\n"
+        << "  stats                print call counts, latency, bytes and allocations per operation\n"
+        << "  help                 show this message\n"
+        << "Exit status: 0 on success, 1 if a command failed, 2 on usage errors.\n";
+}
+
+struct ReportOptions {
+    bool summary = false, totals = false, averages = false, per = false, best = false;
+    MetricMask metrics = 0; // advanced metrics to show; 0 = none
+    string player;  // empty = all players
+    string csvDir;  // empty = no CSV export
+    string csvFile; // empty = no combined CSV export
+};
+
+// Run one report command; report text goes to out, status messages to log
+bool runReport(League& league, const ReportOptions& opt, ostream& out, ostream& log) {
+    vector<const Player*> selected;
+    if (opt.player.empty()) {
+        selected = allPlayers(league.players);
+    }
+    else {
+        int idx = league.find(opt.player);
+        if (idx < 0) {
+            log << "No player named '" << opt.player << "'.\n";
+            return false;
+        }
+        selected.push_back(&league.players[idx]);
+    }
+
+    bool summary = opt.summary || !(opt.totals || opt.averages || opt.per || opt.best || opt.metrics);
+    if (summary) out << "\n=== Quick Player Summary ===\n\n";
+    // Lazily loaded players are paged in a budget's worth at a time
+    bool paged = forEachResidentBatch(league, selected, [&](size_t b, size_t e) {
+        renderInOrder(e - b, out, [&](size_t i, ostream& os) {
+            const Player& p = *selected[b + i];
+            if (summary) showQuickSummaryLine(p, os);
+            if (opt.totals) showTotals(p, os);
+            if (opt.averages) showAverages(p, os);
+            if (opt.per) os << fixed << setprecision(2) << p.name << " - Simple PER: " << simplePER(p) << '\n';
+            if (opt.metrics) showAdvancedMetrics(p, opt.metrics, os);
+            if (opt.best) showBestScoringGames(p, os);
+            });
+        }, log);
+    out.flush(); // report boundary
+    if (!paged) return false;
+
+    if (!opt.csvFile.empty() && !exportLeagueCSV(league, selected, opt.csvFile, log)) return false;
+    if (opt.csvDir.empty()) return true;
+    error_code ec;
+    filesystem::create_directories(opt.csvDir, ec);
+    if (ec) {
+        log << "Cannot create directory '" << opt.csvDir << "': " << ec.message() << ".\n";
+        return false;
+    }
+    return exportPlayersToCSV(league, selected, opt.csvDir, log);
+}
+
+// Chart every player (or just player, if given)
+bool runChart(League& league, const ChartOptions& opt, const string& player, ostream& out, ostream& log) {
+    vector<const Player*> selected;
+    if (player.empty()) {
+        selected = allPlayers(league.players);
+    }
+    else {
+        int idx = league.find(player);
+        if (idx < 0) {
+            log << "No player named '" << player << "'.\n";
+            return false;
+        }
+        selected.push_back(&league.players[idx]);
+    }
+    bool paged = forEachResidentBatch(league, selected, [&](size_t b, size_t e) {
+        renderInOrder(e - b, out, [&](size_t i, ostream& os) {
+            const Player& p = *selected[b + i];
+            os << "\n--- " << p.name << " ---\n";
+            showAsciiChart(p, opt, os);
+            });
+        }, log);
+    out.flush();
+    return paged;
+}
+
+struct QueryOptions {
+    bool last = false;
+    size_t lastGames = 0;
+    int32_t from = INT32_MIN, to = INT32_MAX;
+    string player;  // empty = all players
+};
+
+// Run one query command over the selected players
+bool runQuery(League& league, const QueryOptions& opt, ostream& out, ostream& log) {
+    vector<const Player*> selected;
+    if (opt.player.empty()) {
+        selected = allPlayers(league.players);
+    }
+    else {
+        int idx = league.find(opt.player);
+        if (idx < 0) {
+            log << "No player named '" << opt.player << "'.\n";
+            return false;
+        }
+        selected.push_back(&league.players[idx]);
+    }
+    string label = opt.last ? "Last " + to_string(opt.lastGames) + " games"
+        : (opt.from == INT32_MIN ? string("start") : formatDate(opt.from)) + " to "
+        + (opt.to == INT32_MAX ? string("end") : formatDate(opt.to));
+    // The query indexes are built lazily on first use, one player per task
+    bool paged = forEachResidentBatch(league, selected, [&](size_t b, size_t e) {
+        renderInOrder(e - b, out, [&](size_t i, ostream& os) {
+            const Player& p = *selected[b + i];
+            showQueryResult(p, label, opt.last ? p.byDate.lastGames(p.games, opt.lastGames)
+                : p.byDate.dateRange(p.games, opt.from, opt.to), os);
+            });
+        }, log);
+    out.flush();
+    return paged;
+}
+
+// Entry point for "bstats <command> ...". Reports go to stdout and status
+// or error messages to stderr; nothing is ever read from stdin.
+int runCommandLine(const vector<string>& args) {
+    League league;
+    size_t i = 0;
+
+    // Fetch the value for the option/command at args[i]
+    auto value = [&](string& v) {
+        if (i + 1 >= args.size()) {
+            diagnostics << "Missing argument for '" << args[i] << "'.\n";
+            return false;
+        }
+        v = args[++i];
+        return true;
+        };
+
+    for (; i < args.size(); ++i) {
+        const string& cmd = args[i];
+        string file, other;
+        if (cmd == "help" || cmd == "--help" || cmd == "-h") {
+            printUsage(console);
+            return 0;
+        }
+        else if (cmd == "load") {
+            if (!value(file)) return 2;
+            ArchiveFilter filter;
+            bool part = false;
+            while (i + 1 < args.size() && (args[i + 1] == "--player" || args[i + 1] == "--season")) {
+                const string& o = args[++i];
+                string v;
+                if (!value(v)) return 2;
+                part = true;
+                if (o == "--player") filter.player = v;
+                else if (from_chars(v.data(), v.data() + v.size(), filter.season).ptr != v.data() + v.size()) {
+                    diagnostics << "Invalid season '" << v << "'.\n";
+                    return 2;
+                }
+            }
+            if (!(part ? loadArchivePart(league, file, filter, diagnostics) : loadDataFile(league, file, diagnostics))) return 1;
+        }
+        else if (cmd == "merge") {
+            if (!value(file)) return 2;
+            if (!loadDataFile(league, file, diagnostics, true)) return 1;
+        }
+        else if (cmd == "save") {
+            if (!value(file)) return 2;
+            if (!saveDataFile(league, file, FORMAT_TEXT, diagnostics)) return 1;
+        }
+        else if (cmd == "snapshot") {
+            if (!value(file)) return 2;
+            if (!saveDataFile(league, file, FORMAT_SNAPSHOT, diagnostics)) return 1;
+        }
+        else if (cmd == "archive") {
+            if (!value(file)) return 2;
+            if (!saveDataFile(league, file, FORMAT_ARCHIVE, diagnostics)) return 1;
+        }
+        else if (cmd == "convert") {
+            if (!value(file) || !value(other)) return 2;
+            DataFormat format = convertTargetFor(file);
+            if (i + 1 < args.size() && args[i + 1].compare(0, 2, "--") == 0) {
+                const string& o = args[++i];
+                if (o == "--text") format = FORMAT_TEXT;
+                else if (o == "--snapshot") format = FORMAT_SNAPSHOT;
+                else if (o == "--archive") format = FORMAT_ARCHIVE;
+                else {
+                    diagnostics << "Unknown convert option '" << o << "'.\n";
+                    return 2;
+                }
+            }
+            if (!convertDataFile(file, other, format, diagnostics)) return 1;
+        }
+        else if (cmd == "import") {
+            if (!value(file)) return 2;
+            string name = playerNameForCSV(file);
+            if (i + 1 < args.size() && args[i + 1] == "--player") {
+                ++i;
+                if (!value(name)) return 2;
+            }
+            if (!importPlayerCSV(league, file, name, diagnostics)) return 1;
+        }
+        else if (cmd == "ingest") {
+            if (!value(file)) return 2;
+            if (!ingestLeagueCSV(league, file, diagnostics)) return 1;
+        }
+        else if (cmd == "report") {
+            ReportOptions opt;
+            while (i + 1 < args.size() && args[i + 1].compare(0, 2, "--") == 0) {
+                const string& o = args[++i];
+                if (o == "--summary") opt.summary = true;
+                else if (o == "--totals") opt.totals = true;
+                else if (o == "--avg") opt.averages = true;
+                else if (o == "--per") opt.per = true;
+                else if (o == "--best") opt.best = true;
+                else if (o == "--advanced") opt.metrics = ALL_METRICS;
+                else if (o == "--metrics") {
+                    string list;
+                    if (!value(list)) return 2;
+                    if (!parseMetrics(list, opt.metrics)) {
+                        diagnostics << "Unknown metric in '" << list << "'.\n";
+                        return 2;
+                    }
+                }
+                else if (o == "--player") { if (!value(opt.player)) return 2; }
+                else if (o == "--csv-dir") { if (!value(opt.csvDir)) return 2; }
+                else if (o == "--csv") { if (!value(opt.csvFile)) return 2; }
+                else {
+                    diagnostics << "Unknown report option '" << o << "'.\n";
+                    return 2;
+                }
+            }
+            if (!runReport(league, opt, console, diagnostics)) return 1;
+        }
+        else if (cmd == "query") {
+            QueryOptions opt;
+            while (i + 1 < args.size() && args[i + 1].compare(0, 2, "--") == 0) {
+                const string& o = args[++i];
+                string v;
+                if (o == "--player") { if (!value(opt.player)) return 2; continue; }
+                if (!value(v)) return 2;
+                bool ok = true;
+                if (o == "--from") ok = parseDate(v, opt.from);
+                else if (o == "--to") ok = parseDate(v, opt.to);
+                else if (o == "--last") { opt.last = true; ok = parseNumber(v, opt.lastGames) && opt.lastGames > 0; }
+                else {
+                    diagnostics << "Unknown query option '" << o << "'.\n";
+                    return 2;
+                }
+                if (!ok) {
+                    diagnostics << "Invalid value '" << v << "' for " << o << ".\n";
+                    return 2;
+                }
+            }
+            if (!runQuery(league, opt, console, diagnostics)) return 1;
+        }
+        else if (cmd == "top") {
+            Ranking r;
+            bool games = false;
+            int k = 10;
+            while (i + 1 < args.size() && args[i + 1].compare(0, 2, "--") == 0) {
+                const string& o = args[++i];
+                if (o == "--games") { games = true; continue; }
+                string v;
+                if (!value(v)) return 2;
+                bool ok = true;
+                if (o == "--by") ok = parseRanking(v, r);
+                else if (o == "--count") ok = parseNumber(v, k) && k > 0;
+                else {
+                    diagnostics << "Unknown top option '" << o << "'.\n";
+                    return 2;
+                }
+                if (!ok) {
+                    diagnostics << "Invalid value '" << v << "' for " << o << ".\n";
+                    return 2;
+                }
+            }
+            if (!pageInAll(league, diagnostics)) return 1;
+            if (games) showGameBoard(league.players, boardTitle("Top ", k, true, r), cachedBoard(league, r, k, true));
+            else showPlayerBoard(league.players, boardTitle("Top ", k, false, r), r, cachedBoard(league, r, k, false));
+            console.flush();
+        }
+        else if (cmd == "chart") {
+            ChartOptions opt;
+            string player;
+            while (i + 1 < args.size() && args[i + 1].compare(0, 2, "--") == 0) {
+                const string& o = args[++i];
+                string v;
+                if (!value(v)) return 2;
+                bool ok = true;
+                if (o == "--stat") {
+                    Ranking r;
+                    ok = parseRanking(v, r) && r.kind == Ranking::TOTAL;
+                    opt.stat = r.stat;
+                }
+                else if (o == "--by") {
+                    int b = 0;
+                    while (b < NUM_CHART_BUCKETS && (b == CHART_ROLLING || v != CHART_BUCKET_NAMES[b])) ++b;
+                    ok = b < NUM_CHART_BUCKETS;
+                    if (ok) opt.bucket = (ChartBucket)b;
+                }
+                else if (o == "--rolling") { opt.bucket = CHART_ROLLING; ok = parseNumber(v, opt.window) && opt.window > 0; }
+                else if (o == "--width") ok = parseNumber(v, opt.width) && opt.width > 0;
+                else if (o == "--player") player = v;
+                else {
+                    diagnostics << "Unknown chart option '" << o << "'.\n";
+                    return 2;
+                }
+                if (!ok) {
+                    diagnostics << "Invalid value '" << v << "' for " << o << ".\n";
+                    return 2;
+                }
+            }
+            if (!runChart(league, opt, player, console, diagnostics)) return 1;
+        }
+        else if (cmd == "group") {
+            vector<GroupKey> keys = { GROUP_TEAM, GROUP_SEASON };
+            string player;
+            while (i + 1 < args.size() && args[i + 1].compare(0, 2, "--") == 0) {
+                const string& o = args[++i];
+                string v;
+                if (!value(v)) return 2;
+                if (o == "--by") {
+                    if (!parseGroupKeys(v, keys)) {
+                        diagnostics << "Invalid value '" << v << "' for " << o << ".\n";
+                        return 2;
+                    }
+                }
+                else if (o == "--player") player = v;
+                else {
+                    diagnostics << "Unknown group option '" << o << "'.\n";
+                    return 2;
+                }
+            }
+            if (!runGroupBy(league, keys, player, console, diagnostics)) return 1;
+        }
+        else if (cmd == "serve") {
+            ServeOptions opt;
+            while (i + 1 < args.size() && args[i + 1].compare(0, 2, "--") == 0) {
+                const string& o = args[++i];
+                string v;
+                if (!value(v)) return 2;
+                bool ok = true;
+                if (o == "--port") ok = parseNumber(v, opt.port) && opt.port > 0 && opt.port < 65536;
+                else if (o == "--bind") opt.host = v;
+                else {
+                    diagnostics << "Unknown serve option '" << o << "'.\n";
+                    return 2;
+                }
+                if (!ok) {
+                    diagnostics << "Invalid value '" << v << "' for " << o << ".\n";
+                    return 2;
+                }
+            }
+            if (!runServer(league, opt, diagnostics)) return 1;
+        }
+        else if (cmd == "memory") {
+            showMemory(league);
+            console.flush();
+        }
+        else if (cmd == "stats") {
+            showInstrumentation(console);
+            console.flush();
+        }
+        else if (cmd == "generate" || cmd == "bench") {
+            size_t players = 30, games = 82;
+            BenchOptions bench;
+            while (i + 1 < args.size() && args[i + 1].compare(0, 2, "--") == 0) {
+                const string& o = args[++i];
+                string v;
+                if (!value(v)) return 2;
+                bool ok = true, known = true;
+                if (o == "--seed") ok = parseNumber(v, bench.seed);
+                else if (cmd == "generate" && o == "--players") ok = parseNumber(v, players) && players > 0;
+                else if (cmd == "generate" && o == "--games") ok = parseNumber(v, games);
+                else if (cmd == "bench" && o == "--reps") ok = parseNumber(v, bench.reps) && bench.reps > 0;
+                else if (cmd == "bench" && o == "--dir") bench.dir = v;
+                else if (cmd == "bench" && o == "--sizes") {
+                    bench.sizes.clear();
+                    string_view rest = v;
+                    while (ok && !rest.empty()) {
+                        size_t comma = min(rest.find(','), rest.size());
+                        size_t n = 0;
+                        ok = parseNumber(rest.substr(0, comma), n) && n > 0;
+                        bench.sizes.push_back(n);
+                        rest.remove_prefix(min(comma + 1, rest.size()));
+                    }
+                    ok = ok && !bench.sizes.empty();
+                }
+                else known = false;
+                if (!known) {
+                    diagnostics << "Unknown " << cmd << " option '" << o << "'.\n";
+                    return 2;
+                }
+                if (!ok) {
+                    diagnostics << "Invalid value '" << v << "' for " << o << ".\n";
+                    return 2;
+                }
+            }
+            if (cmd == "generate") {
+                generateLeague(league, players, games, bench.seed);
+                status(diagnostics) << "Generated " << players << " players x " << games << " games.\n";
+            }
+            else if (!runBenchmarks(bench, console, diagnostics)) return 1;
+        }
+        else {
+            diagnostics << "Unknown command '" << cmd << "'.\n";
+            printUsage(diagnostics);
+            return 2;
+        }
+        if (compactMode) compactLeague(league);
+        diagnostics.flush();
+    }
+    console.flush();
+    return console ? 0 : 1;
+}
+
+// Write the --trace file, if one was requested
+void saveTrace(const string& filename) {
+    if (filename.empty()) return;
+    if (!writeTrace(filename)) diagnostics << "Cannot write trace file '" << filename << "'.\n";
+    diagnostics.flush();
 }
 
 // ======================================================
 // MAIN MENU: Player-level and global actions
 // ======================================================
 
-int main() {
-    vector<Player> players;
+int main(int argc, char** argv) {
+    // Output goes through the console sink; prompts flush it because cin is tied to it
+    ios::sync_with_stdio(false);
+    cin.tie(&console);
+
+    vector<string> args(argv + 1, argv + argc);
+    string traceFile; // --trace
+    // Global options come before the first command
+    while (!args.empty()) {
+        if (args[0] == "-q") {
+            OutputSink::quiet = true;
+            args.erase(args.begin());
+        }
+        else if (args[0] == "--threads") {
+            int n = 0;
+            if (args.size() < 2 || !parseNumber(args[1], n) || n < 1) {
+                diagnostics << "--threads needs a positive number.\n";
+                diagnostics.flush();
+                return 2;
+            }
+            reportThreads = (unsigned)n;
+            args.erase(args.begin(), args.begin() + 2);
+        }
+        else if (args[0] == "--memory-budget") {
+            size_t mib = 0;
+            if (args.size() < 2 || !parseNumber(args[1], mib) || mib < 1) {
+                diagnostics << "--memory-budget needs a positive number of MiB.\n";
+                diagnostics.flush();
+                return 2;
+            }
+            memoryBudget = mib << 20;
+            args.erase(args.begin(), args.begin() + 2);
+        }
+        else if (args[0] == "--compact") {
+            compactMode = true;
+            args.erase(args.begin());
+        }
+        else if (args[0] == "--trace") {
+            if (args.size() < 2) {
+                diagnostics << "--trace needs a file name.\n";
+                diagnostics.flush();
+                return 2;
+            }
+            traceFile = args[1];
+#if BSTATS_INSTRUMENT
+            tracing = true;
+#endif
+            args.erase(args.begin(), args.begin() + 2);
+        }
+        else break;
+    }
+    if (!args.empty()) {
+        int rc = runCommandLine(args);
+        console.flush();
+        saveTrace(traceFile);
+        diagnostics.flush();
+        return rc;
+    }
+
+    League league;
+    vector<Player>& players = league.players;
+    LiveServer liveServer;
     int choice;
 
-    cout << "Advanced Basketball Statistics Program (CSCI I concepts)\n" << endl;
-    cout << "Features: multiple players, save/load, CSV export, edit/delete, sorting, PER, ASCII charts.\n" << endl;
+    console << "Advanced Basketball Statistics Program (CSCI I concepts)\n\n";
+    console << "Features: multiple players, save/load, CSV export, edit/delete, sorting, PER, ASCII charts.\n\n";
 
     do {
-        cout << "\n=== MAIN MENU ===\n" << endl;
-        cout << "1. Add a player\n" << endl;
-        cout << "2. Select player (open player menu)\n" << endl;
-        cout << "3. Save all players to file\n" << endl;
-        cout << "4. Load players from file\n" << endl;
-        cout << "5. Export all players to individual CSV files\n" << endl;
-        cout << "6. Quick report: list all players and averages\n" << endl;
-        cout << "0. Exit\n" << endl;
+        console << "\n=== MAIN MENU ===\n\n";
+        console << "1. Add a player\n\n";
+        console << "2. Select player (open player menu)\n\n";
+        console << "3. Save all players to file\n\n";
+        console << "4. Load players from file\n\n";
+        console << "5. Export all players to CSV (one league file or one per player)\n\n";
+        console << "6. Quick report: list all players and averages\n\n";
+        console << "7. Save all players to binary snapshot\n\n";
+        console << "8. Load players from binary snapshot\n\n";
+        console << "9. Convert data file (text, binary snapshot, archive)\n\n";
+        console << "10. Find player by name (open player menu)\n\n";
+        console << "11. Merge players from another data file\n\n";
+        console << "12. Leaderboards (top players and games)\n\n";
+        console << "13. Performance counters\n\n";
+        console << "14. Save all players to compressed archive\n\n";
+        console << "15. Group games by team, opponent, season or venue\n\n";
+        console << "16. Memory usage\n\n";
+        console << (liveServer.running() ? "17. Stop live report server\n\n" : "17. Serve live reports over HTTP while entering games\n\n");
+        console << "0. Exit\n\n";
 
         choice = readInt("Choice: ");
         switch (choice) {
         case 1:
-            addPlayer(players);
+            addPlayer(league);
             break;
 
         case 2: {
-            int idx = selectPlayer(players);
-            if (idx >= 0) playerMenu(players[idx]);
+            int idx = selectPlayer(league);
+            if (idx >= 0) playerMenu(league, idx);
             break;
         }
 
         case 3:
-            saveAllPlayersToFile(players);
+            saveDataFile(league, "players_data.txt", FORMAT_TEXT, console, true);
             break;
 
         case 4:
-            loadAllPlayersFromFile(players);
+            openDataFile(league, "players_data.txt");
             break;
 
-        case 5:
-            // Export each player to a CSV named "<playername>.csv" (spaces replaced with underscores)
-            for (const auto& p : players) {
-                string fname = p.name;
-                // sanitize filename: replace spaces with underscores
-                replace(fname.begin(), fname.end(), ' ', '_');
-                fname += ".csv";
-                exportPlayerToCSV(p, fname);
+        case 5: {
+            console << "1. One league CSV with a Player column\n";
+            console << "2. One CSV file per player\n";
+            int kind = readInt("Export type: ");
+            if (kind == 1) {
+                string fname = readLine("League CSV filename (default league.csv): ");
+                if (fname.empty()) fname = "league.csv";
+                exportLeagueCSV(league, allPlayers(players), fname);
+            }
+            else if (kind == 2) {
+                // Export each player to a CSV named "<playername>.csv" (spaces replaced with underscores)
+                exportPlayersToCSV(league, allPlayers(players), "");
+                console << "All players exported to CSV files.\n\n";
+            }
+            else {
+                console << "Invalid choice.\n";
             }
-            cout << "All players exported to CSV files.\n" << endl;
             break;
+        }
 
         case 6:
-            cout << "\n=== Quick Player Summary ===\n" << endl;
-            for (const auto& p : players) {
-                cout << p.name << " - Games: " << p.games.size() << endl;
-                if (!p.games.empty()) {
-                    cout << ", PPG: " << fixed << setprecision(2)
-                        << ([&]() {
-                        double totalPts = 0;
-                        for (const auto& g : p.games) totalPts += g.points;
-                        return totalPts / p.games.size();
-                            }());
-                    cout << ", PER: " << simplePER(p) << endl;
-                }
-                cout << '\n' << endl;
+            showQuickSummary(league);
+            break;
+
+        case 7: {
+            string fname = readLine("Snapshot filename (default players_data.bsnp): ");
+            if (fname.empty()) fname = "players_data.bsnp";
+            saveDataFile(league, fname, FORMAT_SNAPSHOT, console, true);
+            break;
+        }
+
+        case 8: {
+            string fname = readLine("Snapshot filename (default players_data.bsnp): ");
+            if (fname.empty()) fname = "players_data.bsnp";
+            openDataFile(league, fname);
+            break;
+        }
+
+        case 9: {
+            string from = readLine("Input file (text, snapshot or archive): ");
+            string to = readLine("Output file: ");
+            if (from.empty() || to.empty()) { console << "Both filenames are required.\n\n"; break; }
+            DataFormat format = convertTargetFor(from);
+            string kind = readLine(string("Output format (1 text, 2 snapshot, 3 archive; default ") + FORMAT_NAMES[format] + "): ");
+            if (kind == "1" || kind == "2" || kind == "3") format = (DataFormat)(kind[0] - '1');
+            convertDataFile(from, to, format);
+            break;
+        }
+
+        case 10: {
+            int idx = findPlayerByName(league);
+            if (idx >= 0) playerMenu(league, idx);
+            break;
+        }
+
+        case 11: {
+            string fname = readLine("Data file to merge (text, snapshot or archive): ");
+            if (!fname.empty() && loadDataFile(league, fname, console, true)) rewriteJournaledFile(league);
+            break;
+        }
+
+        case 12:
+            if (pageInAll(league)) leaderboardMenu(league);
+            break;
+
+        case 13:
+            showInstrumentation(console);
+            break;
+
+        case 14: {
+            string fname = readLine("Archive filename (default players_data.barc): ");
+            if (fname.empty()) fname = "players_data.barc";
+            saveDataFile(league, fname, FORMAT_ARCHIVE, console, true);
+            break;
+        }
+
+        case 15:
+            groupByMenu(league);
+            break;
+
+        case 16:
+            showMemory(league);
+            break;
+
+        case 17: {
+            if (liveServer.running()) { liveServer.stop(league); break; }
+            ServeOptions opt;
+            string port = readLine("Port (default 8080): ");
+            if (!port.empty() && !(parseNumber(port, opt.port) && opt.port > 0 && opt.port < 65536)) {
+                console << "Invalid port.\n\n";
+                break;
             }
+            liveServer.start(league, opt);
             break;
+        }
 
         case 0:
-            cout << "Exiting program. Tip: save your data (option 3) before quitting.\n" << endl;
+            liveServer.stop(league);
+            if (league.journal.isOpen()) console << "Exiting program. Changes are saved in '" << league.journal.dataFile() << "' and its journal.\n\n";
+            else console << "Exiting program. Tip: save your data (option 3) before quitting.\n\n";
             break;
 
         default:
-            cout << "Invalid choice.\n" << endl;
+            console << "Invalid choice.\n\n";
         }
+        maybeCompactJournal(league);
+        liveServer.sync(league);
+        if (compactMode) compactLeague(league);
 
     } while (choice != 0);
 
+    console.flush();
+    saveTrace(traceFile);
     return 0;
 }
@@ -0,0 +1,74 @@
+#!/bin/bash
+# Round-trip and corruption checks for the data formats and the journal.
+# Usage: ./check.sh [path/to/bstats]   (builds one with g++ if not given)
+set -u
+here=$(cd "$(dirname "$0")" && pwd)
+work=$(mktemp -d)
+trap 'rm -rf "$work"' EXIT
+cd "$work"
+
+if [ $# -ge 1 ]; then
+    B=$(cd "$(dirname "$1")" && pwd)/$(basename "$1")
+else
+    B=$work/bstats
+    ${CXX:-g++} -std=c++17 -O2 -pthread "$here/basketball_stats.cpp" -o "$B" || exit 1
+fi
+
+failures=0
+pass() { echo "ok   $1"; }
+fail() { echo "FAIL $1"; failures=$((failures + 1)); }
+same() { if cmp -s "$2" "$3"; then pass "$1"; else fail "$1"; fi; }
+fails() { if "$@" >/dev/null 2>&1; then fail "rejects ${*: -2:1}"; else pass "rejects ${*: -2:1}"; fi; }
+
+# Reference league in every format, plus its league CSV
+"$B" -q generate --players 50 --games 20 save a.txt snapshot a.bsnp archive a.barc report --csv a.csv >/dev/null
+
+# Each format loads back to the same text file
+for f in a.bsnp a.barc; do
+    "$B" -q load $f save r.txt
+    same "$f round trip" r.txt a.txt
+done
+"$B" -q convert a.barc c.txt --text
+same "archive convert" c.txt a.txt
+"$B" -q ingest a.csv save r.txt
+same "csv ingest" r.txt a.txt
+
+# Every load path gives the same reports
+report() { "$B" -q "$@" report --totals --avg --advanced; }
+report load a.txt > rep.txt
+report load a.bsnp > r.txt; same "snapshot reports" r.txt rep.txt
+report load a.barc > r.txt; same "archive reports" r.txt rep.txt
+report --compact load a.txt > r.txt; same "compact reports" r.txt rep.txt
+report --memory-budget 1 load a.barc > r.txt; same "memory budget reports" r.txt rep.txt
+
+# Truncated files and damaged archive blocks are refused
+for f in a.bsnp a.barc; do
+    head -c $(($(stat -c %s $f) / 2)) $f > t_$f
+    fails "$B" -q load t_$f report
+done
+cp a.barc d_a.barc
+printf '\377\376' | dd of=d_a.barc bs=1 seek=$(($(stat -c %s a.barc) / 3)) conv=notrunc 2>/dev/null
+fails "$B" -q load d_a.barc report
+
+# Journal replay: the edits below are made once and saved in full (menu 3),
+# then made on a copy of each format and left in its journal (menu 8 opens it).
+# Add a game, delete a game, tag a game with a new team, add a player.
+edits='2\n3\n1\n2025-03-01\n20\n5\n4\n1\n0\n8\n15\n2\n5\n2\n2\n3\n1\nDELETE\n15\n2\nCheck Team\n\n\n0\n1\nNew Player\n'
+cp a.txt players_data.txt
+printf "4\n${edits}3\n0\n" | timeout 20 "$B" >/dev/null
+for f in a.txt a.bsnp a.barc; do
+    cp $f j_$f
+    printf "8\nj_$f\n${edits}0\n" | timeout 20 "$B" >/dev/null
+    "$B" -q load j_$f save r.txt
+    same "$f journal replay" r.txt players_data.txt
+done
+# A torn record at the end of a journal is ignored
+printf 'torn' >> j_a.barc.journal
+"$B" -q load j_a.barc save r.txt 2>/dev/null
+same "torn journal tail" r.txt players_data.txt
+# Merging a journaled archive keeps its games
+"$B" -q merge j_a.barc save r.txt
+same "merge journaled archive" r.txt players_data.txt
+
+if [ $failures -ne 0 ]; then echo "$failures check(s) failed"; exit 1; fi
+echo "All checks passed"